@@ -0,0 +1,56 @@
+// Enable async functions
+#define CLI_ASYNC
+#include <arduino_clap.h>
+
+// Setup command line interface objects
+ArduinoCLI* cli;
+
+// Async functions yield back to the CLI instead of calling delay(), so the
+// CLI can still read commands (e.g. `stop blink-fast`) while they run
+CLI_TaskStatus blink_fast(CLITask& task){
+    CLI_TASK_BEGIN(task);
+    Serial.println("Blinking fast!");
+    for(task.counter = 0; task.counter < 10; task.counter++){
+        digitalWrite(BUILTIN_LED, HIGH);
+        CLI_TASK_DELAY(task, 100);
+        digitalWrite(BUILTIN_LED, LOW);
+        CLI_TASK_DELAY(task, 100);
+    }
+    CLI_TASK_END(task);
+}
+
+// Async functions can also accept a value
+CLI_TaskStatus blink_dynamic(CLITask& task, uint16_t rate){
+    CLI_TASK_BEGIN(task);
+    for(task.counter = 0; task.counter < 10; task.counter++){
+        digitalWrite(BUILTIN_LED, HIGH);
+        CLI_TASK_DELAY(task, rate);
+        digitalWrite(BUILTIN_LED, LOW);
+        CLI_TASK_DELAY(task, rate);
+    }
+    CLI_TASK_END(task);
+}
+
+void setup(){
+    Serial.begin(115200);
+    pinMode(BUILTIN_LED, OUTPUT);
+
+    // Pass the serial object into the CLI
+    cli = new ArduinoCLI(Serial);
+
+    cli->add_argument("blink-fast", "Blink the onboard LED fast!", blink_fast);
+    cli->add_argument("blink-dyn", "Blink the onboard LED dynamically!",
+                      blink_dynamic);
+
+    // Enter the CLI
+    cli->enter();
+
+    // In the CLI:
+    // blink-dyn 500
+    // stop blink-dyn
+}
+
+void loop(){
+    // Wont get here until the CLI (cli) is exited with the "exit" command
+    delay(1);
+}
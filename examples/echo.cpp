@@ -1,3 +1,5 @@
+// Enable quoted strings ("Hello World!")
+#define CLI_QUOTED_STRINGS
 #include <arduino_clap.h>
 
 // Setup command line interface objects
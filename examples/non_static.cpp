@@ -12,7 +12,7 @@ auto servo_pos = [](int v){
   servo.write(v);
   Serial.print("Servo Position: ");
   Serial.println(v);
-}
+};
 
 void setup(){
     Serial.begin(115200);
@@ -21,12 +21,159 @@
 
 #include <Arduino.h>
 
-//! Define to enable `range` and `loop` inbuilt functions
+/**
+ * Optional modules, each is only compiled in (and only uses flash and RAM)
+ * when defined before this header is included:
+ *
+ * - CLI_HELP:           Inbuilt `help` command and per argument help text
+ * - CLI_RANGE_LOOP:     Inbuilt `range`, `loop` and `array` functions
+ * - CLI_QUOTED_STRINGS: String values wrapped in quotes ("Hello World")
+ * - CLI_FLOAT:          `float` and `double` arguments
+ * - CLI_SNAPSHOT:       Binary snapshot/restore of bound arguments
+ * - CLI_ASYNC:          Async (resumable) callback functions
+ * - CLI_HASH_INDEX:     Perfect hash index for dispatching many arguments
+ * - CLI_TRANSACTIONS:   Stage a whole command line and commit it at once
+ * - CLI_QUEUE:          Queue parsed commands to be executed elsewhere
+ *
+ * Define CLI_FULL to enable all of the above.
+ */
+#ifdef CLI_FULL
+#define CLI_HELP
 #define CLI_RANGE_LOOP
+#define CLI_QUOTED_STRINGS
+#define CLI_FLOAT
+#define CLI_SNAPSHOT
+#define CLI_ASYNC
+#define CLI_HASH_INDEX
+#define CLI_TRANSACTIONS
+#define CLI_QUEUE
+#endif // CLI_FULL
+
+//! Commands can be parsed ahead of being executed (see `CLICommand`)
+#if defined(CLI_TRANSACTIONS) || defined(CLI_QUEUE)
+#define CLI_STAGING
+#endif
+
+//! Arguments keep a hash of their name (see `cli_hash()`)
+#if defined(CLI_SNAPSHOT) || defined(CLI_HASH_INDEX)
+#define CLI_NAME_HASH
+#endif
+
+//! Maximum number of arguments
+#ifndef CLI_MAX_ARGS
+#define CLI_MAX_ARGS 10
+#endif
+
+//! Returned when an argument is not found (see `ArduinoCLI::find_arg()`)
+#define CLI_ARG_NOT_FOUND 0xFFFF
+
+//! Maximum number of values passed to the inbuilt `array` function
+#ifndef CLI_MAX_ARRAY_LEN
+#define CLI_MAX_ARRAY_LEN 20
+#endif
 
 //! Message buffer for CLI commands entered by the user
 static char cmd_buffer[100]{};
 
+//! Size of the buffer output is collected in before it is written to the stream
+#ifndef CLI_OUT_BUFFER_LEN
+#define CLI_OUT_BUFFER_LEN 64
+#endif
+
+#ifdef CLI_ASYNC
+
+//! Maximum number of async callbacks that can run at once
+#ifndef CLI_MAX_TASKS
+#define CLI_MAX_TASKS 4
+#endif
+
+//! Maximum length of a value passed to an async callback
+#ifndef CLI_TASK_VALUE_LEN
+#define CLI_TASK_VALUE_LEN 16
+#endif
+
+/**
+ * @brief Returned by async callbacks to tell the CLI if they have finished.
+ */
+typedef enum {
+    CLI_TASK_RUNNING,
+    CLI_TASK_DONE,
+} CLI_TaskStatus;
+
+class Arguments;
+
+/**
+ * @brief State of a running async callback.
+ *
+ * Async callbacks are resumed by the CLI until they return `CLI_TASK_DONE`.
+ * Local variables do not survive a yield, use `counter` (or static variables)
+ * for any state that must be kept between resumes.
+ */
+struct CLITask {
+    Arguments* arg = nullptr;           //! Argument being run (free if null)
+    uint16_t line = 0;                  //! Resume point (see `CLI_TASK_*`)
+    uint32_t wake = 0;                  //! Time to resume after a delay (ms)
+    int32_t counter = 0;                //! Scratch value kept between resumes
+    char value[CLI_TASK_VALUE_LEN]{};   //! Value supplied by the user
+};
+
+/**
+ * @brief Macros to write an async callback as a protothread.
+ *
+ * @example
+ * CLI_TaskStatus blink(CLITask& task){
+ *     CLI_TASK_BEGIN(task);
+ *     for(task.counter = 0; task.counter < 10; task.counter++){
+ *         digitalWrite(BUILTIN_LED, !digitalRead(BUILTIN_LED));
+ *         CLI_TASK_DELAY(task, 100);
+ *     }
+ *     CLI_TASK_END(task);
+ * }
+ *
+ * @note `switch` statements cannot be used between `CLI_TASK_BEGIN` and
+ * `CLI_TASK_END`, and only one `CLI_TASK_*` macro can be used per line.
+ */
+#define CLI_TASK_BEGIN(task) switch((task).line){ case 0:
+
+//! Return to the CLI, resuming from here next time the task is run
+#define CLI_TASK_YIELD(task) do { \
+        (task).line = __LINE__; return CLI_TASK_RUNNING; case __LINE__:; \
+    } while(0)
+
+//! Return to the CLI until `ms` milliseconds have passed
+#define CLI_TASK_DELAY(task, ms) do { \
+        (task).wake = millis() + (ms); \
+        (task).line = __LINE__; return CLI_TASK_RUNNING; case __LINE__: \
+        if((int32_t)(millis() - (task).wake) < 0){ return CLI_TASK_RUNNING; } \
+    } while(0)
+
+#define CLI_TASK_END(task) } (task).line = 0; return CLI_TASK_DONE
+
+#endif // CLI_ASYNC
+
+#ifdef CLI_STAGING
+#include <errno.h>
+#include <float.h>
+#include <limits.h>
+
+//! Maximum size of a parsed value (longer strings are rejected)
+#ifndef CLI_VALUE_LEN
+#define CLI_VALUE_LEN 16
+#endif
+
+/**
+ * @brief A command that has been parsed but not yet executed.
+ *
+ * The value is stored already converted to the arguments type (or as a copy
+ * of the string for `const char*` arguments).
+ */
+struct CLICommand {
+    uint16_t arg;                   //! Index of the argument
+    char value[CLI_VALUE_LEN];      //! Parsed value (see `Argument::stage()`)
+};
+
+#endif // CLI_STAGING
+
 /**
  * @breif Generic CLI arguments class.
  *
@@ -39,19 +186,60 @@ static char cmd_buffer[100]{};
  */
 class Arguments {
 public:
+    virtual ~Arguments() {}
+    //! Called by the CLI when it no longer needs the argument
+    virtual void release() { delete this; }
     virtual void execute_callback(const char* arg_val) = 0;
     virtual const char* get_name() = 0;
+#ifdef CLI_HELP
     virtual const char* get_help() = 0;
+#endif
     virtual bool is_void_function() = 0;
+#ifdef CLI_NAME_HASH
+    virtual uint32_t get_hash() = 0;
+#endif
+#ifdef CLI_SNAPSHOT
+    virtual void* get_value() = 0;
+    virtual uint8_t get_value_size() = 0;
+#endif
+#ifdef CLI_ASYNC
+    virtual bool is_async() = 0;
+    virtual CLI_TaskStatus resume(CLITask& task) = 0;
+#endif
+#ifdef CLI_STAGING
+    virtual bool stage(const char* arg_val, char* staged) = 0;
+    virtual void apply(const char* staged) = 0;
+#endif
 };
 
 
+#ifdef CLI_NAME_HASH
+/**
+ * @brief Hash a null terminated string (32-bit FNV-1a).
+ *
+ * Used to key arguments by name without storing the name itself, for example
+ * within a snapshot (see `ArduinoCLI::save()`).
+ *
+ * @param str String to hash.
+ * @return 32-bit hash of `str`.
+ */
+inline uint32_t cli_hash(const char* str){
+    uint32_t hash = 2166136261UL;
+    while(*str){
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+#endif // CLI_NAME_HASH
+
+
 /**
  * @brief Namespace to store conversions from const char* to various types.
  *
  * Supports:
  * - const char* (no-conversion, straight pass)
- * - float, double
+ * - float, double (with CLI_FLOAT)
  * - uint32_t, uint16_t, uint8_t
  * - int32_t, int16_t (int on UNO), uint8_t
  *
@@ -61,8 +249,19 @@ public:
  */
 namespace ParseArg {
     template <typename X>
-    X type(const char* value) { return value; }
+    X type(const char* value) {
+        static_assert(sizeof(X) == 0, "Unsupported argument type (float and "
+                                      "double arguments require CLI_FLOAT)");
+        (void)value;
+        return X();
+    }
+
+    template<>
+    const char* type(const char* value){
+        return value;
+    }
 
+#ifdef CLI_FLOAT
     template<>
     float type(const char* value){
         return (float)strtod(value, nullptr);
@@ -72,6 +271,7 @@ namespace ParseArg {
     double type(const char* value){
         return strtod(value, nullptr);
     }
+#endif // CLI_FLOAT
 
     template<>
     uint32_t type(const char* value){
@@ -113,6 +313,131 @@ namespace ParseArg {
         if(v > INT8_MAX || v < -INT8_MAX){ return 0; }
         return (int8_t)v;
     }
+
+#ifdef CLI_STAGING
+    /**
+     * @brief Is the whole value an integer within [min, max]?
+     */
+    inline bool valid_integer(const char* value, long min, long max){
+        char* end;
+        errno = 0;
+        long v = strtol(value, &end, 10);
+        return end != value && *end == '\0' && errno != ERANGE
+               && v >= min && v <= max;
+    }
+
+    /**
+     * @brief Is the whole value a finite number within [-max, max]?
+     */
+    inline bool valid_real(const char* value, double max){
+        char* end;
+        double v = strtod(value, &end);
+        return end != value && *end == '\0' && v >= -max && v <= max;
+    }
+
+    /**
+     * @brief Can the value be converted to this type without error?
+     *
+     * `type()` converts invalid values to zero, which is fine when the
+     * callback runs straight away but not for staged commands, where one
+     * invalid value must discard the whole line (see `Argument::stage()`).
+     */
+    template <typename X>
+    bool valid(const char* value);
+
+    template<>
+    inline bool valid<const char*>(const char*){ return true; }
+
+#ifdef CLI_FLOAT
+    template<>
+    inline bool valid<float>(const char* value){
+        return valid_real(value, FLT_MAX);
+    }
+
+    template<>
+    inline bool valid<double>(const char* value){
+        return valid_real(value, DBL_MAX);
+    }
+#endif // CLI_FLOAT
+
+    template<>
+    inline bool valid<uint32_t>(const char* value){
+        // Parsed with strtol (see type<uint32_t>()), so limited to LONG_MAX
+        // where long is 32 bits
+        const unsigned long max = (unsigned long)LONG_MAX < UINT32_MAX
+                                  ? LONG_MAX : UINT32_MAX;
+        return valid_integer(value, 0, (long)max);
+    }
+
+    template<>
+    inline bool valid<uint16_t>(const char* value){
+        return valid_integer(value, 0, UINT16_MAX);
+    }
+
+    template<>
+    inline bool valid<uint8_t>(const char* value){
+        return valid_integer(value, 0, UINT8_MAX);
+    }
+
+    template<>
+    inline bool valid<int32_t>(const char* value){
+        return valid_integer(value, -INT32_MAX, INT32_MAX);
+    }
+
+    template<>
+    inline bool valid<int16_t>(const char* value){
+        return valid_integer(value, -INT16_MAX, INT16_MAX);
+    }
+
+    template<>
+    inline bool valid<int8_t>(const char* value){
+        return valid_integer(value, -INT8_MAX, INT8_MAX);
+    }
+#endif // CLI_STAGING
+
+    /**
+     * @brief Can a value of this type be copied byte for byte into storage?
+     *
+     * Strings are pointers into the command buffer so they are not storable.
+     */
+    template <typename X>
+    constexpr bool is_storable() { return true; }
+
+    template<>
+    constexpr bool is_storable<const char*>() { return false; }
+
+#ifdef CLI_STAGING
+    /**
+     * @brief Parse a value into a staging buffer without converting invalid
+     * values to zero or truncating strings (see `valid()`).
+     *
+     * @param value Value provided by user in CLI.
+     * @param staged Buffer of `CLI_VALUE_LEN` bytes to hold the parsed value.
+     * @return True if the value was valid and staged.
+     */
+    template <typename X>
+    bool stage(const char* value, char* staged){
+        static_assert(sizeof(X) <= CLI_VALUE_LEN, "CLI_VALUE_LEN too small");
+        if(!valid<X>(value)){ return false; }
+        if(is_storable<X>()){
+            X v = type<X>(value);
+            memcpy(staged, &v, sizeof(X));
+            return true;
+        }
+        if(strlen(value) >= CLI_VALUE_LEN){ return false; }
+        strcpy(staged, value);
+        return true;
+    }
+
+    //! Get a value back from a buffer populated by `stage()`
+    template <typename X>
+    X unstage(const char* staged){
+        if(!is_storable<X>()){ return type<X>(staged); }
+        X v;
+        memcpy(&v, staged, sizeof(X));
+        return v;
+    }
+#endif // CLI_STAGING
 }
 
 
@@ -120,13 +445,16 @@ namespace ParseArg {
  * @brief Command line argument.
  *
  * Stores the name of the argument, a help string and the callback the argument
- * should trigger. Two constructors are provided, one for callbacks that take
- * a value (of some type) and stand alone callbacks e.g. `callback(void)`.
+ * should trigger. Constructors are provided for callbacks that take a value
+ * (of some type), stand alone callbacks e.g. `callback(void)`, async
+ * callbacks (see `CLI_TASK_BEGIN`) and arguments that are bound directly to a
+ * variable.
  * Functions from within the Arguments class are overwritten here to provide
  * a passthrough between Arguments of different types.
  *
  * @warning The assigning of an argument can silently fail if the name or help
- * message are too long (15 and 75 characters respectively).
+ * message are too long (15 and 75 characters respectively). Help messages
+ * are ignored (and not stored) without CLI_HELP.
  *
  * @tparam T Type of argument expected in callback function.
  */
@@ -134,14 +462,26 @@ template <typename T>
 class Argument : public Arguments {
     static const uint8_t MAX_ARG_LEN    =   15;    //! Argument name length
     static const uint8_t MAX_HELP_LEN   =   75;    //! Help information length
-    char name[MAX_ARG_LEN]{};    //! Argument name
-    char help[MAX_HELP_LEN]{};   //! Help information
+    char name[MAX_ARG_LEN + 1]{};    //! Argument name
+#ifdef CLI_HELP
+    char help[MAX_HELP_LEN + 1]{};   //! Help information
+#endif
+#ifdef CLI_NAME_HASH
+    uint32_t hash = 0;           //! Hash of the argument name
+#endif
     bool void_function = false;
 
 public:
     //! Reference to a callback function that takes a value
     void(*callback)() = nullptr;
     void(*callback_t)(T) = nullptr;
+    //! Variable the argument is bound to (set directly by the CLI)
+    T* value = nullptr;
+#ifdef CLI_ASYNC
+    //! Reference to an async callback function (resumed until done)
+    CLI_TaskStatus(*task_callback)(CLITask&) = nullptr;
+    CLI_TaskStatus(*task_callback_t)(CLITask&, T) = nullptr;
+#endif
 
     /**
      * @breif Several argument constructors are provided, accepting a various
@@ -165,12 +505,46 @@ public:
         }
     }
 
+    //! An argument that writes its value directly into a variable
+    Argument(const char* _name, const char* _help, T* _value) : value(_value) {
+        static_assert(ParseArg::is_storable<T>(),
+                      "Strings point into the command buffer and cannot be "
+                      "bound, use a callback instead");
+        if(!build_arg(_name, _help)){
+            return;
+        }
+    }
+
+#ifdef CLI_ASYNC
+    //! An async argument that does not accept a value
+    Argument(const char* _name, const char* _help,
+             CLI_TaskStatus(*cb)(CLITask&)) : task_callback(cb) {
+        void_function = true;
+        if(!build_arg(_name, _help)){
+            return;
+        }
+    }
+
+    //! An async argument that accepts one value
+    Argument(const char* _name, const char* _help,
+             CLI_TaskStatus(*cb)(CLITask&, T)) : task_callback_t(cb) {
+        if(!build_arg(_name, _help)){
+            return;
+        }
+    }
+#endif
+
     bool build_arg(const char* _name, const char* _help){
         if(!validate_arg(_name, _help)) {
             return false;
         }
-        strncpy(name, _name, MAX_ARG_LEN);
-        strncpy(help, _help, MAX_HELP_LEN);
+        strncpy(name, _name, sizeof(name));
+#ifdef CLI_HELP
+        strncpy(help, _help, sizeof(help));
+#endif
+#ifdef CLI_NAME_HASH
+        hash = cli_hash(name);
+#endif
         return true;
     }
 
@@ -192,15 +566,97 @@ public:
         }
         // Callback with a value type
         T v1 = ParseArg::type<T>(arg_val);
+        if(value){
+            *value = v1;
+            return;
+        }
         callback_t(v1);
     }
 
     //! Get the name of the argument
     const char* get_name() override { return name; }
+#ifdef CLI_HELP
     //! Get help information for argument
     const char* get_help() override { return help; }
+#endif
     //! Check if the function has value
     bool is_void_function() override { return void_function; }
+#ifdef CLI_NAME_HASH
+    //! Get the hash of the arguments name
+    uint32_t get_hash() override { return hash; }
+#endif
+#ifdef CLI_SNAPSHOT
+    //! Get the bound variable (if any)
+    void* get_value() override { return value; }
+    //! Get the size of the bound variable (0 if unbound or not storable)
+    uint8_t get_value_size() override {
+        if(!value || !ParseArg::is_storable<T>()){ return 0; }
+        return sizeof(T);
+    }
+#endif
+
+#ifdef CLI_ASYNC
+    //! Check if the argument has an async callback
+    bool is_async() override {
+        return task_callback || task_callback_t;
+    }
+
+    /**
+     * @brief Resume an async callback from where it last yielded.
+     *
+     * @param task State of the running callback (value is parsed from
+     * `task.value` on every resume).
+     * @return Status of the async callback.
+     */
+    CLI_TaskStatus resume(CLITask& task) override {
+        if(task_callback){
+            return task_callback(task);
+        }
+        if(task_callback_t){
+            return task_callback_t(task, ParseArg::type<T>(task.value));
+        }
+        return CLI_TASK_DONE;
+    }
+#endif
+
+#ifdef CLI_STAGING
+    /**
+     * @brief Parse a value into a staging buffer without executing the
+     * callback (see `apply()`).
+     *
+     * Unlike `execute_callback()`, values that are not valid for the type
+     * (e.g. "abc" or 300 for a uint8_t) and strings that do not fit in
+     * `CLI_VALUE_LEN` are rejected instead of being converted to zero or
+     * truncated.
+     *
+     * @param arg_val Argument value provided by user in CLI.
+     * @param staged Buffer of `CLI_VALUE_LEN` bytes to hold the parsed value.
+     * @return True if the value was valid and staged.
+     */
+    bool stage(const char* arg_val, char* staged) override {
+        if(void_function){ return true; }
+        return ParseArg::stage<T>(arg_val, staged);
+    }
+
+    /**
+     * @brief Executes an arguments callback (or sets its bound variable) with
+     * a value parsed by `stage()`.
+     *
+     * @param staged Buffer populated by `stage()`.
+     */
+    void apply(const char* staged) override {
+        if(void_function){
+            callback();
+            return;
+        }
+        T v1 = ParseArg::unstage<T>(staged);
+        if(value){
+            *value = v1;
+            return;
+        }
+        callback_t(v1);
+    }
+#endif // CLI_STAGING
 
 private:
     /**
@@ -211,87 +667,1052 @@ private:
      * @return Status of valid arguments (true if valid).
      */
     bool validate_arg(const char* _name, const char* _help_info){
-        if(strlen(_name) > MAX_ARG_LEN || strlen(_help_info) > MAX_HELP_LEN){
+        if(strlen(_name) > MAX_ARG_LEN){
             return false;
         }
+#ifdef CLI_HELP
+        if(strlen(_help_info) > MAX_HELP_LEN){
+            return false;
+        }
+#else
+        (void)_help_info;
+#endif
+        return true;
+    }
+};
+
+
+/**
+ * @brief Entry of a command table registered in one go (see
+ * `ArduinoCLI::add_arguments()`).
+ *
+ * Unlike `Argument<T>` an entry is not templated and not allocated: the name
+ * and help are pointers (not copies) and the type of the callback is kept by
+ * a per-type `handler`, so a whole table is one contiguous array.
+ *
+ * @example
+ * CLIEntry table[] = {
+ *     {"led-on", "Turn the LED on.", led_on},       // void callback
+ *     {"speed", "Set the speed.", set_speed},       // void set_speed(int)
+ *     {"gain", "Bound variable.", &gain},           // bound variable
+ * };
+ * cli->add_arguments(table);
+ *
+ * @warning The name and help strings are not copied, so they must outlive
+ * the CLI (e.g. string literals). Async callbacks are not supported.
+ */
+class CLIEntry : public Arguments {
+public:
+    //! What the `handler` is asked to do with a value
+    enum Op : uint8_t { EXECUTE, STAGE, APPLY };
+    //! Converts a value to the callbacks type and executes it (or stages it)
+    typedef bool (*Handler)(const CLIEntry& entry, Op op, const char* value,
+                            char* staged);
+
+    const char* name;            //! Argument name
+#ifdef CLI_HELP
+    const char* help;            //! Help information
+#endif
+#ifdef CLI_NAME_HASH
+    uint32_t hash;               //! Hash of the argument name
+#endif
+    Handler handler;             //! Handler for the callbacks type (if any)
+    void(*callback)();           //! Callback, cast back to its type by `handler`
+    void* value = nullptr;       //! Variable the argument is bound to
+#ifdef CLI_SNAPSHOT
+    uint8_t value_size = 0;      //! Size of the bound variable
+#endif
+
+    //! An entry whose callback does not accept a value
+    CLIEntry(const char* _name, const char* _help, void(*cb)())
+        : handler(nullptr), callback(cb) {
+        build_entry(_name, _help);
+    }
+
+    //! An entry whose callback accepts one value
+    template <typename T>
+    CLIEntry(const char* _name, const char* _help, void(*cb)(T))
+        : handler(handle<T>), callback(reinterpret_cast<void(*)()>(cb)) {
+        build_entry(_name, _help);
+    }
+
+    //! An entry that writes its value directly into a variable
+    template <typename T>
+    CLIEntry(const char* _name, const char* _help, T* _value)
+        : handler(handle<T>), callback(nullptr), value(_value) {
+        static_assert(ParseArg::is_storable<T>(),
+                      "Strings point into the command buffer and cannot be "
+                      "bound, use a callback instead");
+#ifdef CLI_SNAPSHOT
+        value_size = sizeof(T);
+#endif
+        build_entry(_name, _help);
+    }
+
+    //! Entries belong to their table, not to the CLI
+    void release() override {}
+
+    void execute_callback(const char* arg_val) override {
+        if(!handler){
+            callback();
+            return;
+        }
+        handler(*this, EXECUTE, arg_val, nullptr);
+    }
+
+    const char* get_name() override { return name; }
+#ifdef CLI_HELP
+    const char* get_help() override { return help; }
+#endif
+    bool is_void_function() override { return !handler; }
+#ifdef CLI_NAME_HASH
+    uint32_t get_hash() override { return hash; }
+#endif
+#ifdef CLI_SNAPSHOT
+    void* get_value() override { return value; }
+    uint8_t get_value_size() override { return value_size; }
+#endif
+#ifdef CLI_ASYNC
+    bool is_async() override { return false; }
+    CLI_TaskStatus resume(CLITask&) override { return CLI_TASK_DONE; }
+#endif
+#ifdef CLI_STAGING
+    bool stage(const char* arg_val, char* staged) override {
+        return !handler || handler(*this, STAGE, arg_val, staged);
+    }
+
+    void apply(const char* staged) override {
+        if(!handler){
+            callback();
+            return;
+        }
+        handler(*this, APPLY, staged, nullptr);
+    }
+#endif // CLI_STAGING
+
+private:
+    void build_entry(const char* _name, const char* _help){
+        name = _name;
+#ifdef CLI_HELP
+        help = _help;
+#else
+        (void)_help;
+#endif
+#ifdef CLI_NAME_HASH
+        hash = cli_hash(_name);
+#endif
+    }
+
+    /**
+     * @brief Handler for callbacks (or bound variables) of type `T`.
+     *
+     * @param entry Entry being executed.
+     * @param op Execute `value`, stage `value` into `staged` or apply a
+     * value previously staged (passed as `value`).
+     * @param value Argument value provided by user in CLI (or staged).
+     * @param staged Buffer of `CLI_VALUE_LEN` bytes (`STAGE` only).
+     * @return False if the value could not be staged.
+     */
+    template <typename T>
+    static bool handle(const CLIEntry& entry, Op op, const char* value,
+                       char* staged){
+        T v1;
+        switch(op){
+#ifdef CLI_STAGING
+            case STAGE:
+                return ParseArg::stage<T>(value, staged);
+            case APPLY:
+                v1 = ParseArg::unstage<T>(value);
+                break;
+#endif
+            default:
+                (void)staged;
+                v1 = ParseArg::type<T>(value);
+        }
+        if(entry.value){
+            *static_cast<T*>(entry.value) = v1;
+        } else {
+            reinterpret_cast<void(*)(T)>(entry.callback)(v1);
+        }
         return true;
     }
 };
 
 
+#ifdef CLI_SNAPSHOT
+
+//! Size of each snapshot slot in storage (bytes)
+#ifndef CLI_SNAPSHOT_SLOT_SIZE
+#define CLI_SNAPSHOT_SLOT_SIZE 128
+#endif
+
+/**
+ * @brief Storage backend for argument snapshots.
+ *
+ * Implement this for whatever non-volatile memory is available (EEPROM, a
+ * flash page, a file etc.). Storage is split into `CLI_SNAPSHOT_SLOT_SIZE`
+ * slots which are written in turn to spread wear across the whole region.
+ */
+class CLIStorage {
+public:
+    //! Total number of bytes available
+    virtual size_t length() = 0;
+    //! Read `len` bytes starting at `address` into `data`
+    virtual void read(size_t address, uint8_t* data, size_t len) = 0;
+    //! Write `len` bytes from `data` starting at `address`
+    virtual void write(size_t address, const uint8_t* data, size_t len) = 0;
+    //! Called once a snapshot has been completely written
+    virtual void commit() {}
+};
+
+#ifdef EEPROM_h
+/**
+ * @brief Storage backend using the Arduino EEPROM library.
+ *
+ * @note `EEPROM.h` must be included before `arduino_clap.h`. On the ESP32 and
+ * ESP8266 `EEPROM.begin()` must be called before use.
+ */
+class EEPROMStorage : public CLIStorage {
+public:
+    size_t length() override { return EEPROM.length(); }
+
+    void read(size_t address, uint8_t* data, size_t len) override {
+        for(size_t i = 0; i < len; i++){
+            data[i] = EEPROM.read(address + i);
+        }
+    }
+
+    void write(size_t address, const uint8_t* data, size_t len) override {
+        for(size_t i = 0; i < len; i++){
+#ifdef __AVR__
+            EEPROM.update(address + i, data[i]); // Skips unchanged cells
+#else
+            EEPROM.write(address + i, data[i]);
+#endif
+        }
+    }
+
+#if defined(ESP32) || defined(ESP8266)
+    void commit() override { EEPROM.commit(); }
+#endif
+};
+#endif // EEPROM_h
+
+#ifndef ARDUINO
+/**
+ * @brief Storage backend using a file, for host builds (e.g. tests).
+ *
+ * The file is created if needed and padded with erased (0xFF) bytes up to
+ * `length` bytes.
+ */
+class FileStorage : public CLIStorage {
+public:
+    FileStorage(const char* path, size_t _length) : size(_length) {
+        file = fopen(path, "r+b");
+        if(!file){
+            file = fopen(path, "w+b");
+        }
+        if(!file){ return; }
+        fseek(file, 0, SEEK_END);
+        for(long end = ftell(file); end >= 0 && (size_t)end < size; end++){
+            fputc(0xFF, file);
+        }
+        fflush(file);
+    }
+
+    ~FileStorage(){
+        if(file){ fclose(file); }
+    }
+
+    FileStorage(const FileStorage&) = delete;
+    FileStorage& operator=(const FileStorage&) = delete;
+
+    //! Was the file opened successfully
+    bool is_open() { return file != nullptr; }
+
+    size_t length() override { return file ? size : 0; }
+
+    void read(size_t address, uint8_t* data, size_t len) override {
+        size_t n = 0;
+        if(file && fseek(file, (long)address, SEEK_SET) == 0){
+            n = fread(data, 1, len, file);
+        }
+        memset(data + n, 0xFF, len - n);
+    }
+
+    void write(size_t address, const uint8_t* data, size_t len) override {
+        if(file && fseek(file, (long)address, SEEK_SET) == 0){
+            fwrite(data, 1, len, file);
+        }
+    }
+
+    void commit() override {
+        if(file){ fflush(file); }
+    }
+
+private:
+    //! Open storage file
+    FILE* file = nullptr;
+    //! Number of bytes available
+    size_t size;
+};
+#endif // ARDUINO
+
+/**
+ * @brief Header at the start of each snapshot slot.
+ *
+ * Followed by `count` entries of: name hash (4 bytes), value size (1 byte)
+ * and the value itself.
+ */
+struct CLISnapshotHeader {
+    uint16_t magic;      //! Always `CLI_SNAPSHOT_MAGIC`
+    uint8_t version;     //! Format version
+    uint8_t count;       //! Number of entries
+    uint16_t sequence;   //! Incremented on every save (newest slot wins)
+    uint16_t length;     //! Length of the entries (bytes)
+    uint16_t crc;        //! CRC-16 of the entries and the above fields
+};
+
+#define CLI_SNAPSHOT_MAGIC 0xC1A9
+#define CLI_SNAPSHOT_VERSION 1
+
+#endif // CLI_SNAPSHOT
+
+#ifdef CLI_HASH_INDEX
+
+//! Average number of arguments per bucket of the perfect hash index
+#ifndef CLI_INDEX_BUCKET_SIZE
+#define CLI_INDEX_BUCKET_SIZE 4
+#endif
+
+/**
+ * @brief Slot in the perfect hash index of argument names.
+ *
+ * The name hash and name are kept alongside the argument index, so a lookup
+ * confirms a match without touching the argument itself.
+ */
+struct CLIIndexEntry {
+    uint32_t hash;      //! Hash of the argument name (see `cli_hash()`)
+    const char* name;   //! Name of the argument
+    uint16_t arg;       //! Index of the argument
+};
+
+#endif // CLI_HASH_INDEX
+
+#ifdef CLI_TRANSACTIONS
+//! Maximum number of commands in a single transaction
+#ifndef CLI_MAX_STAGED
+#define CLI_MAX_STAGED 8
+#endif
+
+//! No staged transaction is waiting to be committed
+#define CLI_NO_TRANSACTION 0xFF
+#endif // CLI_TRANSACTIONS
+
+#ifdef CLI_QUEUE
+
+//! Number of commands the queue can hold (must be a power of 2, max 128)
+#ifndef CLI_QUEUE_LEN
+#define CLI_QUEUE_LEN 8
+#endif
+
+#if CLI_QUEUE_LEN & (CLI_QUEUE_LEN - 1) || CLI_QUEUE_LEN > 128
+#error "CLI_QUEUE_LEN must be a power of 2 (max 128)"
+#endif
+
+/**
+ * @brief Fixed capacity, lock-free queue of parsed commands.
+ *
+ * Safe with a single producer (e.g. `serialEvent()` or a low priority task
+ * parsing input) and a single consumer (e.g. the main control loop) running in
+ * different contexts. The producer only writes `head` and the consumer only
+ * writes `tail`. Both are single bytes accessed with acquire/release
+ * ordering, so a command is completely written before it becomes visible.
+ */
+class CLICommandQueue {
+    CLICommand commands[CLI_QUEUE_LEN]{};
+    uint8_t head = 0;       //! Next slot to write (producer)
+    uint8_t tail = 0;       //! Next slot to read (consumer)
+
+public:
+    /**
+     * @brief Get the next free slot (producer only).
+     *
+     * The command is not visible to the consumer until `push()` is called.
+     *
+     * @return Free slot or nullptr if the queue is full.
+     */
+    CLICommand* reserve(){
+        uint8_t _tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        if((uint8_t)(head - _tail) >= CLI_QUEUE_LEN){ return nullptr; }
+        return &commands[head & (CLI_QUEUE_LEN - 1)];
+    }
+
+    //! Publish the slot returned by `reserve()` (producer only)
+    void push(){
+        __atomic_store_n(&head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+    }
+
+    //! Get the oldest command or nullptr if empty (consumer only)
+    CLICommand* front(){
+        if(__atomic_load_n(&head, __ATOMIC_ACQUIRE) == tail){ return nullptr; }
+        return &commands[tail & (CLI_QUEUE_LEN - 1)];
+    }
+
+    //! Release the command returned by `front()` (consumer only)
+    void pop(){
+        __atomic_store_n(&tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    }
+
+    //! Number of commands waiting
+    uint8_t size(){
+        return __atomic_load_n(&head, __ATOMIC_ACQUIRE)
+               - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    }
+};
+
+#endif // CLI_QUEUE
+
 /**
  * @brief Arduino command line interface that parses user input.
- * @note Maximum number of arguments is 10.
+ * @note Maximum number of arguments is `CLI_MAX_ARGS` (10 by default).
  */
 class ArduinoCLI {
     //! Output stream (typically `Serial`)
     Stream& stream;
     //! Collection of command line arguments
-    Arguments* args[10]{};
+    Arguments* args[CLI_MAX_ARGS]{};
     //! Number of stored command line arguments
-    uint8_t n_args = 0;
+    uint16_t n_args = 0;
+#ifdef CLI_HASH_INDEX
+    //! Perfect hash index of argument names (one slot per argument)
+    CLIIndexEntry* index = nullptr;
+    //! Seed for each bucket of the index
+    uint16_t* index_seeds = nullptr;
+    //! Number of buckets in the index
+    uint16_t n_buckets = 0;
+#endif
     //! Collection of command line argument sub arguments
     //Arguments* sub_args[5]{};
     ////! Number of stored command line sub arguments
     //uint8_t n_sub_args = 0;
-    //! Buffer to hold a single line of a help message (see `help()`)
-    char help_buffer[100]{};
+    //! Buffer to collect output before writing it to the stream (see `out()`)
+    char out_buffer[CLI_OUT_BUFFER_LEN]{};
+    //! Number of bytes waiting in the output buffer
+    uint8_t out_len = 0;
 #ifdef CLI_RANGE_LOOP
     //! Buffer to hold values that are passed to the inbuilt `array` function
-    char* arr_buffer[20]{};
+    char* arr_buffer[CLI_MAX_ARRAY_LEN]{};
     //! Index within array buffer
     uint8_t arr_buffer_index = 0;
 #endif
+#ifdef CLI_ASYNC
+    //! Async callbacks that are currently running
+    CLITask tasks[CLI_MAX_TASKS]{};
+#endif
+    //! Has the prompt been printed since the CLI was (re-)entered
+    bool prompted = false;
+    //! Next character to tokenize within `cmd_buffer` (see `next_token()`)
+    char* cursor = nullptr;
+#ifdef CLI_TRANSACTIONS
+    //! Are command lines staged and committed as a whole
+    bool transactional = false;
+    //! Double buffer of staged commands (one being parsed, one committed)
+    CLICommand staged[2][CLI_MAX_STAGED]{};
+    //! Number of commands in each buffer
+    uint8_t n_staged[2]{};
+    //! Buffer commands are being staged into
+    uint8_t staging = 0;
+    //! Buffer waiting to be committed (or `CLI_NO_TRANSACTION`), accessed
+    //! with acquire/release ordering (see `commit()`)
+    uint8_t pending = CLI_NO_TRANSACTION;
+#endif
+#ifdef CLI_QUEUE
+    //! Are parsed commands queued instead of executed (see `drain()`)
+    bool queued = false;
+    //! Commands waiting to be executed
+    CLICommandQueue queue;
+    //! Number of commands dropped because the queue was full
+    volatile uint16_t overflows = 0;
+#endif
+    //! Length of the line being received into `cmd_buffer`
+    uint8_t line_len = 0;
+    //! Did the line being received overflow `cmd_buffer`
+    bool line_overflow = false;
+
+public:
+    /**
+     * @brief Constructor for ArduinoCLI.
+     *
+     * @param _serial Stream for incoming and outgoing msgs.
+     */
+    explicit ArduinoCLI(Stream& _serial) : stream(_serial) {}
+
+    /**
+     * @brief ArduinoCLI destructor, clears all arguments.
+     */
+    ~ArduinoCLI() {
+        for(uint16_t i = 0; i < n_args; i++){
+            args[i]->release();
+        }
+#ifdef CLI_HASH_INDEX
+        delete[] index;
+        delete[] index_seeds;
+#endif
+    }
+
+    /**
+     * @brief Add argument to CLI.
+     *
+     * @tparam T Dummy template (not used, or required by user).
+     * @param name Name of argument.
+     * @param help Help information surrounding argument.
+     * @param cb Callback function that does not accept a value.
+     */
+    template <typename T = uint8_t>
+    void add_argument(const char* name, const char* help,
+                      void(*cb)()){
+        store_arg(new Argument<T>(name, help, cb)); // No values (void)
+    }
+
+    template <typename T>
+    void add_argument(const char* name, const char* help,
+                      void(*cb)(T)){
+        store_arg(new Argument<T>(name, help, cb)); // One value
+    }
+
+    /**
+     * @brief Add argument that is bound directly to a variable.
+     *
+     * @note Strings (`const char*`) cannot be bound as they would point into
+     * the command buffer, which is overwritten by the next command.
+     *
+     * @tparam T Type of the variable.
+     * @param name Name of argument.
+     * @param help Help information surrounding argument.
+     * @param value Variable to write the users value to.
+     */
+    template <typename T>
+    void add_argument(const char* name, const char* help, T* value){
+        store_arg(new Argument<T>(name, help, value)); // Bound value
+    }
+
+    /**
+     * @brief Add a whole table of arguments (see `CLIEntry`).
+     *
+     * Nothing is allocated or copied per entry, the CLI points into the table
+     * so it must outlive the CLI. With CLI_HASH_INDEX the index is then built
+     * over every argument (see `build_index()`).
+     *
+     * @param table Arguments to add.
+     * @param n Number of entries in `table`.
+     * @return True if every entry was added (and, with CLI_HASH_INDEX, the
+     * index was built).
+     */
+    bool add_arguments(CLIEntry* table, uint16_t n){
+        uint16_t added = 0;
+        for(; added < n && n_args < CLI_MAX_ARGS; added++){
+            store_arg(&table[added]);
+        }
+#ifdef CLI_HASH_INDEX
+        if(!build_index()){ return false; }
+#endif
+        return added == n;
+    }
+
+    //! Add a whole table of arguments, sized by the compiler
+    template <size_t N>
+    bool add_arguments(CLIEntry (&table)[N]){
+        return add_arguments(table, N);
+    }
+
+#ifdef CLI_ASYNC
+    /**
+     * @brief Add argument with an async callback to CLI.
+     *
+     * Async callbacks are resumed by the CLI (see `run_tasks()`) until they
+     * return `CLI_TASK_DONE`, so the CLI keeps reading input while they run.
+     * A running callback can be cancelled with `stop <name>`.
+     *
+     * @tparam T Dummy template (not used, or required by user).
+     * @param name Name of argument.
+     * @param help Help information surrounding argument.
+     * @param cb Async callback function that does not accept a value.
+     */
+    template <typename T = uint8_t>
+    void add_argument(const char* name, const char* help,
+                      CLI_TaskStatus(*cb)(CLITask&)){
+        store_arg(new Argument<T>(name, help, cb)); // No values (async)
+    }
+
+    template <typename T>
+    void add_argument(const char* name, const char* help,
+                      CLI_TaskStatus(*cb)(CLITask&, T)){
+        store_arg(new Argument<T>(name, help, cb)); // One value (async)
+    }
+
+    /**
+     * @brief Resume every running async callback once.
+     *
+     * Called by `enter()` between reading commands.
+     */
+    void run_tasks(){
+        for(uint8_t i = 0; i < CLI_MAX_TASKS; i++){
+            if(!tasks[i].arg){ continue; }
+            if(tasks[i].arg->resume(tasks[i]) == CLI_TASK_DONE){
+                tasks[i].arg = nullptr;
+            }
+        }
+    }
+#endif // CLI_ASYNC
+
+    /**
+     * @brief Find an argument by name.
+     *
+     * Once `build_index()` has been called (with CLI_HASH_INDEX) this is a
+     * single hash, one index lookup and one `strcmp`, otherwise every
+     * argument name is compared in turn.
+     *
+     * @param name Name of the argument.
+     * @return Index of the argument or `CLI_ARG_NOT_FOUND`.
+     */
+    uint16_t find_arg(const char* name){
+#ifdef CLI_HASH_INDEX
+        if(index){
+            uint32_t hash = cli_hash(name);
+            const CLIIndexEntry& entry =
+                index[index_slot(hash, index_seeds[hash % n_buckets])];
+            if(entry.hash == hash && strcmp(entry.name, name) == 0){
+                return entry.arg;
+            }
+            return CLI_ARG_NOT_FOUND;
+        }
+#endif
+        for(uint16_t i = 0; i < n_args; i++){
+            if(strcmp(args[i]->get_name(), name) == 0){
+                return i;
+            }
+        }
+        return CLI_ARG_NOT_FOUND;
+    }
+
+#ifdef CLI_HASH_INDEX
+    /**
+     * @brief Build a minimal perfect hash index over all argument names.
+     *
+     * Arguments are split into buckets by name hash, then each bucket
+     * (largest first) is given the first seed that places all of its
+     * arguments into free slots.
+     *
+     * Call once after all arguments have been added (e.g. at the end of
+     * `setup()`). Adding another argument discards the index, lookups then
+     * scan every argument until this is called again. The parser never
+     * builds the index itself, so parsing does not allocate.
+     *
+     * @return True if the index was built (false if there are no arguments or
+     * two arguments share a name, in which case lookups scan every argument).
+     */
+    bool build_index(){
+        clear_index();
+        if(!n_args){ return false; }
+
+        n_buckets = (n_args + CLI_INDEX_BUCKET_SIZE - 1) / CLI_INDEX_BUCKET_SIZE;
+        index = new CLIIndexEntry[n_args];
+        index_seeds = new uint16_t[n_buckets]();
+        for(uint16_t i = 0; i < n_args; i++){
+            index[i].arg = CLI_ARG_NOT_FOUND;
+        }
+
+        // Sort arguments by bucket, bucket b is order[end[b - 1]..end[b])
+        uint16_t* order = new uint16_t[n_args];
+        uint16_t* end = new uint16_t[n_buckets + 1]();
+        for(uint16_t i = 0; i < n_args; i++){
+            end[args[i]->get_hash() % n_buckets + 1]++;
+        }
+        uint16_t largest = 0;
+        for(uint16_t b = 0; b < n_buckets; b++){
+            if(end[b + 1] > largest){ largest = end[b + 1]; }
+            end[b + 1] += end[b];
+        }
+        for(uint16_t i = 0; i < n_args; i++){
+            order[end[args[i]->get_hash() % n_buckets]++] = i;
+        }
+
+        // Largest buckets are the hardest to place so they go first
+        bool built = true;
+        for(uint16_t size = largest; size > 0 && built; size--){
+            for(uint16_t b = 0; b < n_buckets && built; b++){
+                uint16_t begin = b ? end[b - 1] : 0;
+                if(end[b] - begin == size){
+                    built = place_bucket(order + begin, size, b);
+                }
+            }
+        }
+        delete[] order;
+        delete[] end;
+
+        if(!built){
+            clear_index();
+        }
+        return built;
+    }
+#endif // CLI_HASH_INDEX
+
+#ifdef CLI_TRANSACTIONS
+    /**
+     * @brief Enable or disable transactional mode.
+     *
+     * In transactional mode every command on a line is parsed and validated
+     * into a staging buffer instead of being executed. If every command is
+     * valid the line is applied as a whole by the next `commit()`, if any
+     * command fails nothing is applied.
+     *
+     * @param enable Enable transactional mode.
+     */
+    void set_transactional(bool enable){
+        transactional = enable;
+    }
+
+    /**
+     * @brief Apply the most recently staged command line.
+     *
+     * Call from a safe point in the control loop (or an ISR). Staging uses a
+     * separate buffer, so the CLI can keep parsing while a commit runs. The
+     * cost is bounded by `CLI_MAX_STAGED` callbacks.
+     *
+     * The buffer is handed over through `pending` with acquire/release
+     * ordering (as in `CLICommandQueue`), so a commit never sees a partly
+     * staged line, even from another core.
+     *
+     * @return True if a staged command line was applied.
+     */
+    bool commit(){
+        uint8_t bank = __atomic_load_n(&pending, __ATOMIC_ACQUIRE);
+        if(bank == CLI_NO_TRANSACTION){ return false; }
+        for(uint8_t i = 0; i < n_staged[bank]; i++){
+            args[staged[bank][i].arg]->apply(staged[bank][i].value);
+        }
+        // Only now may the parser stage into this buffer again
+        __atomic_store_n(&pending, (uint8_t)CLI_NO_TRANSACTION,
+                         __ATOMIC_RELEASE);
+        return true;
+    }
+#endif // CLI_TRANSACTIONS
+
+#ifdef CLI_QUEUE
+    /**
+     * @brief Enable or disable queued mode.
+     *
+     * In queued mode parsed commands are pushed to a queue instead of being
+     * executed, so parsing (`update()` or `feed()`) and execution (`drain()`)
+     * can happen in different contexts. `stop`, async callbacks and the
+     * `range`, `loop` and `array` helpers are rejected. Ignored in
+     * transactional mode.
+     *
+     * @note Parsing writes to the stream (echo, errors and prompt), so do not
+     * call `update()` or `feed()` from an interrupt handler.
+     *
+     * @param enable Enable queued mode.
+     */
+    void set_queued(bool enable){
+        queued = enable;
+    }
+
+    /**
+     * @brief Execute queued commands, oldest first.
+     *
+     * Call at a fixed point of the control loop. Limiting `n` bounds the time
+     * spent executing commands each cycle.
+     *
+     * @param n Maximum number of commands to execute.
+     * @return Number of commands executed.
+     */
+    uint8_t drain(uint8_t n = CLI_QUEUE_LEN){
+        uint8_t executed = 0;
+        CLICommand* cmd;
+        while(executed < n && (cmd = queue.front())){
+            args[cmd->arg]->apply(cmd->value);
+            queue.pop();
+            executed++;
+        }
+        return executed;
+    }
+
+    //! Number of commands waiting in the queue
+    uint8_t queued_commands(){ return queue.size(); }
+
+    //! Number of commands dropped because the queue was full
+    uint16_t queue_overflows(){ return overflows; }
+#endif // CLI_QUEUE
+
+#ifdef CLI_SNAPSHOT
+    /**
+     * @brief Save the value of every bound argument to storage.
+     *
+     * Values are written to the slot after the most recent valid snapshot so
+     * writes are spread across the storage. The header is written last, so a
+     * reset during a save leaves the previous snapshot intact. This needs at
+     * least two slots, so smaller storage is rejected.
+     *
+     * @param storage Storage backend to write to.
+     * @return True if the snapshot was written (false if storage holds fewer
+     * than two slots, or the values do not fit in one slot or number more
+     * than 255).
+     */
+    bool save(CLIStorage& storage){
+        uint16_t n_slots = storage.length() / CLI_SNAPSHOT_SLOT_SIZE;
+        if(n_slots < 2){ return false; }
+
+        CLISnapshotHeader header{};
+        int16_t slot = find_snapshot(storage, header);
+        header.sequence = slot < 0 ? 0 : header.sequence + 1;
+        slot = slot < 0 ? 0 : (slot + 1) % n_slots;
+
+        size_t address = (size_t)slot * CLI_SNAPSHOT_SLOT_SIZE
+                         + sizeof(CLISnapshotHeader);
+        size_t end = (size_t)(slot + 1) * CLI_SNAPSHOT_SLOT_SIZE;
+        uint16_t crc = 0xFFFF;
+        header.count = 0;
+        header.length = 0;
+
+        for(uint16_t i = 0; i < n_args; i++){
+            uint8_t size = args[i]->get_value_size();
+            if(!size){ continue; }
+            if(address + sizeof(uint32_t) + 1 + size > end
+               || header.count == UINT8_MAX){
+                return false;
+            }
+
+            uint32_t hash = args[i]->get_hash();
+            write_snapshot(storage, address, (const uint8_t*)&hash,
+                           sizeof(hash), crc);
+            write_snapshot(storage, address, &size, 1, crc);
+            write_snapshot(storage, address, (const uint8_t*)args[i]->get_value(),
+                           size, crc);
+            header.length += sizeof(hash) + 1 + size;
+            header.count++;
+        }
+
+        header.magic = CLI_SNAPSHOT_MAGIC;
+        header.version = CLI_SNAPSHOT_VERSION;
+        header.crc = snapshot_header_crc(header, crc);
+        storage.write((size_t)slot * CLI_SNAPSHOT_SLOT_SIZE,
+                      (const uint8_t*)&header, sizeof(header));
+        storage.commit();
+        return true;
+    }
+
+    /**
+     * @brief Restore the value of every bound argument from storage.
+     *
+     * Values are copied straight into the bound variables (no text parsing).
+     * Stored values without a matching argument (by name hash and size) are
+     * skipped.
+     *
+     * @param storage Storage backend to read from.
+     * @return True if a valid snapshot was found and restored.
+     */
+    bool restore(CLIStorage& storage){
+        CLISnapshotHeader header{};
+        int16_t slot = find_snapshot(storage, header);
+        if(slot < 0){ return false; }
+
+        size_t address = (size_t)slot * CLI_SNAPSHOT_SLOT_SIZE
+                         + sizeof(CLISnapshotHeader);
+        for(uint8_t i = 0; i < header.count; i++){
+            uint32_t hash;
+            uint8_t size;
+            storage.read(address, (uint8_t*)&hash, sizeof(hash));
+            storage.read(address + sizeof(hash), &size, 1);
+            address += sizeof(hash) + 1;
+
+            for(uint16_t j = 0; j < n_args; j++){
+                if(args[j]->get_hash() == hash
+                   && args[j]->get_value_size() == size){
+                    storage.read(address, (uint8_t*)args[j]->get_value(), size);
+                    break;
+                }
+            }
+            address += size;
+        }
+        return true;
+    }
+#endif // CLI_SNAPSHOT
+
+    /**
+     * @brief CLI state for printing helpful error messages.
+     */
+    typedef enum {
+        CLI_OK,
+        CLI_ERROR,
+        CLI_UNKNOWN_COMMAND,
+        CLI_HELP_OK,
+        CLI_EXPECTED_VALUE_NOT_FOUND,
+        CLI_TASKS_FULL,
+        CLI_TASK_NOT_RUNNING,
+        CLI_NOT_STAGEABLE,
+        CLI_STAGING_FULL,
+        CLI_COMMIT_PENDING,
+        CLI_QUEUE_FULL,
+        CLI_INVALID_VALUE,
+        CLI_TOO_MANY_VALUES,
+        CLI_LINE_TOO_LONG,
+    } CLI_Status;
 
-public:
+private:
     /**
-     * @brief Constructor for ArduinoCLI.
+     * @brief Store a newly created argument.
      *
-     * @param _serial Stream for incoming and outgoing msgs.
+     * @warning Arguments are silently discarded once `CLI_MAX_ARGS` is reached.
+     *
+     * @param arg Argument to store (owned by the CLI).
      */
-    explicit ArduinoCLI(Stream& _serial) : stream(_serial) {}
+    void store_arg(Arguments* arg){
+        if(n_args >= CLI_MAX_ARGS){
+            arg->release();
+            return;
+        }
+        args[n_args++] = arg;
+#ifdef CLI_HASH_INDEX
+        clear_index(); // No longer covers every argument
+#endif
+    }
+
+#ifdef CLI_HASH_INDEX
+    //! Free the index (lookups fall back to scanning every argument)
+    void clear_index(){
+        delete[] index;
+        delete[] index_seeds;
+        index = nullptr;
+        index_seeds = nullptr;
+    }
+
+    //! Slot within the index for a name hash and bucket seed
+    uint16_t index_slot(uint32_t hash, uint16_t seed){
+        hash ^= seed * 0x9E3779B9UL;
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6BUL;
+        hash ^= hash >> 13;
+        return hash % n_args;
+    }
 
     /**
-     * @brief ArduinoCLI destructor, clears all arguments.
+     * @brief Find a seed that places every argument in a bucket into a free
+     * slot of the index.
+     *
+     * @param members Indexes of the arguments in the bucket.
+     * @param size Number of arguments in the bucket.
+     * @param bucket Bucket to find the seed for.
+     * @return True if a seed was found.
      */
-    ~ArduinoCLI() {
-        for(uint8_t i = 0; i < n_args; i++){
-            free(args[i]);
+    bool place_bucket(const uint16_t* members, uint16_t size, uint16_t bucket){
+        for(uint16_t seed = 1; seed != 0; seed++){
+            uint16_t placed = 0;
+            for(; placed < size; placed++){
+                uint32_t hash = args[members[placed]]->get_hash();
+                CLIIndexEntry& entry = index[index_slot(hash, seed)];
+                if(entry.arg != CLI_ARG_NOT_FOUND){ break; }
+                entry.hash = hash;
+                entry.name = args[members[placed]]->get_name();
+                entry.arg = members[placed];
+            }
+            if(placed == size){
+                index_seeds[bucket] = seed;
+                return true;
+            }
+            // Collision, undo this attempt and try the next seed
+            while(placed--){
+                uint32_t hash = args[members[placed]]->get_hash();
+                index[index_slot(hash, seed)].arg = CLI_ARG_NOT_FOUND;
+            }
         }
+        return false;
     }
+#endif // CLI_HASH_INDEX
 
+#ifdef CLI_SNAPSHOT
     /**
-     * @brief Add argument to CLI.
+     * @brief CRC-16/CCITT of a block of bytes.
      *
-     * @tparam T Dummy template (not used, or required by user).
-     * @param name Name of argument.
-     * @param help Help information surrounding argument.
-     * @param cb Callback function that does not accept a value.
+     * @param crc Running CRC (start with 0xFFFF).
+     * @param data Bytes to add to the CRC.
+     * @param len Number of bytes.
+     * @return Updated CRC.
      */
-    template <typename T = uint8_t>
-    void add_argument(const char* name, const char* help,
-                      void(*cb)()){
-        args[n_args++] = new Argument<T>(name, help, cb); // No values (void)
+    static uint16_t crc16(uint16_t crc, const uint8_t* data, size_t len){
+        while(len--){
+            crc ^= (uint16_t)*data++ << 8;
+            for(uint8_t i = 0; i < 8; i++){
+                crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+            }
+        }
+        return crc;
     }
 
-    template <typename T>
-    void add_argument(const char* name, const char* help,
-                      void(*cb)(T)){
-        args[n_args++] = new Argument<T>(name, help, cb); // One value
+    //! Adds the header fields (excluding the trailing CRC) to a running CRC
+    static uint16_t snapshot_header_crc(const CLISnapshotHeader& header,
+                                        uint16_t crc){
+        return crc16(crc, (const uint8_t*)&header,
+                     sizeof(CLISnapshotHeader) - sizeof(header.crc));
+    }
+
+    //! Write to storage, advancing `address` and updating `crc`
+    static void write_snapshot(CLIStorage& storage, size_t& address,
+                               const uint8_t* data, size_t len, uint16_t& crc){
+        storage.write(address, data, len);
+        crc = crc16(crc, data, len);
+        address += len;
     }
 
     /**
-     * @brief CLI state for printing helpful error messages.
+     * @brief Find the most recent valid snapshot in storage.
+     *
+     * @param storage Storage backend to search.
+     * @param header Populated with the header of the snapshot found.
+     * @return Slot of the snapshot, or -1 if no valid snapshot exists.
      */
-    typedef enum {
-        CLI_OK,
-        CLI_ERROR,
-        CLI_UNKNOWN_COMMAND,
-        CLI_HELP_OK,
-        CLI_EXPECTED_VALUE_NOT_FOUND,
-    } CLI_Status;
+    static int16_t find_snapshot(CLIStorage& storage,
+                                 CLISnapshotHeader& header){
+        uint16_t n_slots = storage.length() / CLI_SNAPSHOT_SLOT_SIZE;
+        int16_t newest = -1;
+        CLISnapshotHeader candidate{};
+
+        for(uint16_t slot = 0; slot < n_slots; slot++){
+            size_t address = (size_t)slot * CLI_SNAPSHOT_SLOT_SIZE;
+            storage.read(address, (uint8_t*)&candidate, sizeof(candidate));
+            if(candidate.magic != CLI_SNAPSHOT_MAGIC
+               || candidate.version != CLI_SNAPSHOT_VERSION
+               || candidate.length > CLI_SNAPSHOT_SLOT_SIZE
+                                     - sizeof(CLISnapshotHeader)){
+                continue;
+            }
+
+            // Sequence numbers wrap, compare using the signed difference
+            if(newest >= 0
+               && (int16_t)(candidate.sequence - header.sequence) <= 0){
+                continue;
+            }
+
+            uint16_t crc = 0xFFFF;
+            uint8_t chunk[16];
+            address += sizeof(CLISnapshotHeader);
+            for(uint16_t i = 0; i < candidate.length; i += sizeof(chunk)){
+                uint16_t len = candidate.length - i;
+                if(len > sizeof(chunk)){ len = sizeof(chunk); }
+                storage.read(address + i, chunk, len);
+                crc = crc16(crc, chunk, len);
+            }
+            if(snapshot_header_crc(candidate, crc) != candidate.crc){
+                continue;
+            }
+
+            header = candidate;
+            newest = slot;
+        }
+        return newest;
+    }
+#endif // CLI_SNAPSHOT
 
-private:
     /**
      * @brief Arduino CLI error handler based on `CLI_Status`.
      * @param input Input from user.
@@ -302,45 +1723,185 @@ private:
             case CLI_OK:
                 return;
             case CLI_UNKNOWN_COMMAND:
-                stream.print("Unknown command: ");
+                out(F("Unknown command: "));
                 break;
             case CLI_EXPECTED_VALUE_NOT_FOUND:
-                stream.println("Expected value not found.");
+                out(F("Expected value not found.\r\n"));
+                return;
+            case CLI_TASKS_FULL:
+                out(F("Too many running functions: "));
+                break;
+            case CLI_TASK_NOT_RUNNING:
+                out(F("Function not running: "));
+                break;
+            case CLI_NOT_STAGEABLE:
+                out(F("Cannot be staged: "));
+                break;
+            case CLI_STAGING_FULL:
+                out(F("Too many commands, nothing applied: "));
+                break;
+            case CLI_INVALID_VALUE:
+                out(F("Invalid value: "));
+                break;
+            case CLI_TOO_MANY_VALUES:
+                out(F("Too many values for: "));
+                break;
+            case CLI_QUEUE_FULL:
+                out(F("Command queue full, dropped: "));
+                break;
+            case CLI_COMMIT_PENDING:
+                out(F("Previous commands not committed, nothing applied.\r\n"));
+                return;
+            case CLI_LINE_TOO_LONG:
+                out(F("Line too long, nothing applied.\r\n"));
                 return;
             default:
                 return;
         }
-        stream.println(input);
+        out(input);
+        out(F("\r\n"));
     }
 
+#ifdef CLI_HELP
     /**
      * @brief Prints out help information for all arguments and helper
      * functions.
+     *
+     * Names are padded to the longest registered name, help information is
+     * not padded.
      */
     void help(){
-        stream.println("OPTIONS:");
-        for(uint8_t i = 0; i < n_args; i++){
-            print_help_line(args[i]->get_name(), args[i]->get_help());
+        uint8_t width = 5; // Longest helper name ("range")
+        for(uint16_t i = 0; i < n_args; i++){
+            uint8_t len = strlen(args[i]->get_name());
+            if(len > width){ width = len; }
+        }
+        width += 2;
+
+        out(F("OPTIONS:\r\n"));
+        for(uint16_t i = 0; i < n_args; i++){
+            print_help_line(args[i]->get_name(), args[i]->get_help(), width);
         }
-        stream.println("HELPERS:");
-        print_help_line("help", "Print out help information.");
+        out(F("HELPERS:\r\n"));
+        print_help_line(F("help"), F("Print out help information."), width);
 #ifdef CLI_RANGE_LOOP
-        print_help_line("range", "Execute function with values within a range "
-                                 "(start:stop:interval_ms).");
-        print_help_line("loop", "Execute function in loop with values "
-                                "(start:stop:interval_ms).");
-        print_help_line("array", "Execute function with values provided in "
-                                 "array (interval:[v1, v2...]).");
-        print_help_line("stop", "Stop loop or array function.");
+        print_help_line(F("range"), F("Execute function with values within a "
+                                      "range (start:stop:interval_ms)."), width);
+        print_help_line(F("loop"), F("Execute function in loop with values "
+                                     "(start:stop:interval_ms)."), width);
+        print_help_line(F("array"), F("Execute function with values provided "
+                                      "in array (interval:[v1, v2...])."), width);
 #endif // CLI_RANGE_LOOP
-        print_help_line("exit", "Exit CLI cleanly.");
+#if defined(CLI_RANGE_LOOP) && defined(CLI_ASYNC)
+        print_help_line(F("stop"), F("Stop loop, array or async function "
+                                     "(stop [name])."), width);
+#elif defined(CLI_RANGE_LOOP)
+        print_help_line(F("stop"), F("Stop loop or array function."), width);
+#elif defined(CLI_ASYNC)
+        print_help_line(F("stop"), F("Stop async function (stop [name])."),
+                        width);
+#endif
+        print_help_line(F("exit"), F("Exit CLI cleanly."), width);
+    }
+
+    /**
+     * @brief Output a single line of help information.
+     *
+     * @tparam S String type (`const char*` or flash string from `F()`).
+     * @param _name Argument name.
+     * @param _help Argument help information.
+     * @param width Width to pad the name to.
+     */
+    template <typename S>
+    void print_help_line(S _name, S _help, uint8_t width){
+        out('\t');
+        for(uint8_t len = out(_name); len < width; len++){
+            out(' ');
+        }
+        out(_help);
+        out(F("\r\n"));
+    }
+#endif // CLI_HELP
+
+    /**
+     * @brief Add a character to the output buffer.
+     *
+     * The buffer is written to the stream with `flush()` once a response
+     * (echo, errors or help and the prompt) is complete, and before a
+     * callback runs so that the callback's own output follows the echo. A
+     * response longer than `CLI_OUT_BUFFER_LEN` (e.g. `help`) is written each
+     * time the buffer fills.
+     *
+     * @param c Character to output.
+     * @return Number of characters added (1).
+     */
+    uint8_t out(char c){
+        if(out_len == sizeof(out_buffer)){
+            flush();
+        }
+        out_buffer[out_len++] = c;
+        return 1;
+    }
+
+    //! Add a string to the output buffer
+    uint8_t out(const char* str){
+        uint8_t len = 0;
+        while(*str){
+            len += out(*str++);
+        }
+        return len;
+    }
+
+    //! Add a string stored in flash (see `F()`) to the output buffer
+    uint8_t out(const __FlashStringHelper* str){
+        const char* p = reinterpret_cast<const char*>(str);
+        uint8_t len = 0;
+        char c;
+        while((c = pgm_read_byte(p++))){
+            len += out(c);
+        }
+        return len;
     }
 
-    void print_help_line(const char* _name, const char* _help){
-        snprintf(help_buffer, sizeof(help_buffer), "\t%-20s%-80s",
-                 _name, _help);
-        stream.println(help_buffer);
-        memset(help_buffer, 0, sizeof(help_buffer));
+    //! Write the output buffer to the stream
+    void flush(){
+        if(!out_len){ return; }
+        stream.write((const uint8_t*)out_buffer, out_len);
+        out_len = 0;
+    }
+
+    /**
+     * @brief Write any pending output, then execute an argument's callback.
+     *
+     * @param arg Argument to execute.
+     * @param value Value to pass to the callback.
+     */
+    void execute(Arguments* arg, const char* value){
+        flush();
+        arg->execute_callback(value);
+    }
+
+    /**
+     * @brief Format an integer as a decimal string (without `snprintf`).
+     *
+     * @param buf Buffer to write to (at least 12 characters).
+     * @param value Value to format.
+     * @return `buf`.
+     */
+    static char* format_int(char* buf, int32_t value){
+        char tmp[11];
+        uint8_t n = 0;
+        uint32_t v = value < 0 ? -(uint32_t)value : (uint32_t)value;
+        do {
+            tmp[n++] = '0' + v % 10;
+            v /= 10;
+        } while(v);
+
+        char* p = buf;
+        if(value < 0){ *p++ = '-'; }
+        while(n){ *p++ = tmp[--n]; }
+        *p = '\0';
+        return buf;
     }
 
 #ifdef CLI_RANGE_LOOP
@@ -365,25 +1926,31 @@ private:
             _range = false;
         }
 
-        input = strtok(nullptr, " ");
+        input = next_token(" ");
 
         if(!input){
             handle_error(input, CLI_EXPECTED_VALUE_NOT_FOUND);
             return CLI_EXPECTED_VALUE_NOT_FOUND;
         }
 
-        char start_buf[6];
-        char stop_buf[6];
-        char interval_buf[10];
+        char start_buf[6]{};
+        char stop_buf[6]{};
+        char interval_buf[10]{};
 
-        sscanf(input, "%5[^:]:%5[^:]:%9s", start_buf, stop_buf, interval_buf);
+        // All three fields must be present (and fit their buffers)
+        if(sscanf(input, "%5[^:]:%5[^:]:%9s",
+                  start_buf, stop_buf, interval_buf) != 3){
+            handle_error(input, CLI_INVALID_VALUE);
+            return CLI_INVALID_VALUE;
+        }
 
         int32_t start = ParseArg::type<int32_t>(start_buf);
         int32_t stop = ParseArg::type<int32_t>(stop_buf);
         uint32_t interval = ParseArg::type<uint32_t>(interval_buf);
 
         if(start > stop){
-            return CLI_ERROR;
+            handle_error(input, CLI_INVALID_VALUE);
+            return CLI_INVALID_VALUE;
         }
 
         if(_range){
@@ -409,14 +1976,12 @@ private:
      */
     void execute_range_fn(Arguments* arg, int32_t start, int32_t stop,
                           uint32_t interval){
-        char range_buf[6]{};
+        char range_buf[12]{};
         for(int32_t i = start; i <= stop; i++){
             if(range_loop_exit()){
                 return;
             }
-            snprintf(range_buf, sizeof(range_buf), "%ld", i);
-            arg->execute_callback(range_buf);
-            memset(range_buf, 0, sizeof(range_buf));
+            execute(arg, format_int(range_buf, i));
             delay(interval);
         }
 
@@ -437,46 +2002,38 @@ private:
      */
     void execute_loop_fn(Arguments* arg, int32_t start, int32_t stop,
                          uint32_t interval) {
-        char range_buf[6]{};
+        char range_buf[12]{};
         while (true) {
             for (int32_t i = start; i <= stop; i++) {
                 if(range_loop_exit()) { return; }
-                snprintf(range_buf, sizeof(range_buf), "%ld", i);
-                arg->execute_callback(range_buf);
-                memset(range_buf, 0, sizeof(range_buf));
+                execute(arg, format_int(range_buf, i));
                 delay(interval);
             }
             for (int32_t i = stop-1; i >= start+1; i--) {
                 if(range_loop_exit()){ return; }
-                snprintf(range_buf, sizeof(range_buf), "%ld", i);
-                arg->execute_callback(range_buf);
-                memset(range_buf, 0, sizeof(range_buf));
+                execute(arg, format_int(range_buf, i));
                 delay(interval);
             }
         }
     }
 
     /**
-     * @brief Strip non-digit character from a character array.
+     * @brief Trim the array brackets and spaces from around a value.
      *
-     * An example being "[8" would be striped to "8". The negative symbol `-`
-     * and the '.' character are ignored. For example, the `input` of "[-50.1]"
-     * would result in "-50.1".
+     * An example being "[8" would be trimmed to "8" and " -50.1]" to "-50.1".
+     * Characters within the value are left untouched (e.g. "8.2e1").
      *
-     * @param input Character array to have its non-digit characters removed.
-     * @return Character array with digits only (and `-` or `.`).
+     * @param input Value from within an array.
+     * @return Pointer to the start of the trimmed value (within `input`).
      */
-    static char* strip_non_digits(char* input){
-        char* dest = input;
-        char* src = input;
-        while(*src){
-            if(isdigit(*src) || *src == '-' || *src == '.') {
-                *dest++ = *src++;
-            } else {
-                src++;
-            }
+    static char* trim_array_value(char* input){
+        while(*input == ' ' || *input == '['){
+            input++;
+        }
+        char* end = input + strlen(input);
+        while(end > input && (end[-1] == ' ' || end[-1] == ']')){
+            *--end = '\0';
         }
-        *dest = '\0';
         return input;
     }
 
@@ -502,7 +2059,7 @@ private:
         arr_buffer_index = 0;
 
         // Extract interval between each array value
-        input = strtok(nullptr, ":");
+        input = next_token(":");
 
         if(!input){
             handle_error(input, CLI_EXPECTED_VALUE_NOT_FOUND);
@@ -511,12 +2068,16 @@ private:
 
         uint32_t interval = ParseArg::type<uint32_t>(input);
 
-        input = strtok(nullptr, ",");
+        input = next_token(",");
 
         while(input){
-            char* raw_value = strip_non_digits(input);
-            arr_buffer[arr_buffer_index++] = raw_value;
-            input = strtok(nullptr, ",");
+            if(arr_buffer_index >= CLI_MAX_ARRAY_LEN){
+                arr_buffer_index = 0;
+                handle_error(arg->get_name(), CLI_TOO_MANY_VALUES);
+                return CLI_TOO_MANY_VALUES;
+            }
+            arr_buffer[arr_buffer_index++] = trim_array_value(input);
+            input = next_token(",");
         }
 
         execute_array_fn(arg, interval);
@@ -537,7 +2098,7 @@ private:
     void execute_array_fn(Arguments* arg, uint32_t interval) {
         for(uint8_t i = 0; i < arr_buffer_index; i++){
             if(range_loop_exit()){ return; }
-            arg->execute_callback(arr_buffer[i]);
+            execute(arg, arr_buffer[i]);
             delay(interval);
         }
     }
@@ -545,13 +2106,26 @@ private:
     /**
      * @brief Checks if the user has supplied a `stop` command when in a
      * `loop` function.
+     *
+     * Reads into its own buffer, `cmd_buffer` still holds the values of the
+     * running `array` function.
+     *
      * @return Has the user entered stop?
      */
     bool range_loop_exit(){
         if(stream.available()){
-            stream.readBytesUntil('\n', cmd_buffer, sizeof(cmd_buffer)-1);
-            cmd_buffer[strcspn(cmd_buffer, "\r\n")] = '\0';
-            if(strcmp("stop", cmd_buffer) == 0){
+            char input[8]{};
+            size_t len = stream.readBytesUntil('\n', input, sizeof(input)-1);
+            input[len] = '\0';
+            input[strcspn(input, "\r\n")] = '\0';
+
+            // Discard the rest of a longer line (it is not `stop`)
+            char discard[8];
+            while(len == sizeof(input)-1){
+                len = stream.readBytesUntil('\n', discard, sizeof(discard)-1);
+                input[0] = '\0';
+            }
+            if(strcmp("stop", input) == 0){
                 return true;
             }
         }
@@ -559,20 +2133,197 @@ private:
     }
     #endif // CLI_RANGE_LOOP
 
-    static char* get_next_value(char* input){
-        // Peek input to see if it is wrapped in quotations
-        input = strtok(nullptr, "");
-        if(!input){
-            return input;
+#ifdef CLI_ASYNC
+    /**
+     * @brief Start an async callback in a free task slot.
+     *
+     * @param arg Argument with an async callback.
+     * @param value Value supplied by the user (nullptr for void callbacks).
+     * @return Status of the CLI.
+     */
+    CLI_Status start_task(Arguments* arg, const char* value){
+        // Async callbacks run over time so cannot be staged or queued
+        if(deferred()){
+            handle_error(arg->get_name(), CLI_NOT_STAGEABLE);
+            return CLI_NOT_STAGEABLE;
+        }
+        for(uint8_t i = 0; i < CLI_MAX_TASKS; i++){
+            if(tasks[i].arg){ continue; }
+            tasks[i] = CLITask();
+            tasks[i].arg = arg;
+            if(value){
+                strncpy(tasks[i].value, value, CLI_TASK_VALUE_LEN - 1);
+            }
+            return CLI_OK;
         }
+        handle_error(arg->get_name(), CLI_TASKS_FULL);
+        return CLI_TASKS_FULL;
+    }
 
-        if(input[0] == '\"'){
-            input = strtok(input, "\"");
-        } else {
-            input = strtok(input, " ");
+    /**
+     * @brief Cancel running async callbacks.
+     *
+     * @example
+     * stop             // Cancel all
+     * stop blink-fast  // Cancel every running `blink-fast`
+     *
+     * @param name Name of the argument to cancel (nullptr to cancel all).
+     * @return Status of the CLI.
+     */
+    CLI_Status stop_tasks(const char* name){
+        bool found = false;
+        for(uint8_t i = 0; i < CLI_MAX_TASKS; i++){
+            if(!tasks[i].arg){ continue; }
+            if(!name || strcmp(tasks[i].arg->get_name(), name) == 0){
+                tasks[i].arg = nullptr;
+                found = true;
+            }
         }
+        if(name && !found){
+            handle_error(name, CLI_TASK_NOT_RUNNING);
+            return CLI_TASK_NOT_RUNNING;
+        }
+        return CLI_OK;
+    }
+#endif // CLI_ASYNC
 
-        return input;
+#ifdef CLI_TRANSACTIONS
+    /**
+     * @brief Parse a command into the staging buffer (transactional mode).
+     *
+     * @param i Index of the argument.
+     * @param input Value supplied by the user (nullptr for void arguments).
+     * @return Status of the CLI.
+     */
+    CLI_Status stage_arg(uint16_t i, const char* input){
+        if(n_staged[staging] >= CLI_MAX_STAGED){
+            handle_error(args[i]->get_name(), CLI_STAGING_FULL);
+            return CLI_STAGING_FULL;
+        }
+        CLICommand& cmd = staged[staging][n_staged[staging]];
+        cmd.arg = i;
+        if(input && !args[i]->stage(input, cmd.value)){
+            handle_error(input, CLI_INVALID_VALUE);
+            return CLI_INVALID_VALUE;
+        }
+        n_staged[staging]++;
+        return CLI_OK;
+    }
+
+    /**
+     * @brief Make the staged commands available to `commit()`.
+     * @return Status of the CLI.
+     */
+    CLI_Status publish_staged(){
+        if(!n_staged[staging]){ return CLI_OK; }
+        if(__atomic_load_n(&pending, __ATOMIC_ACQUIRE) != CLI_NO_TRANSACTION){
+            handle_error(nullptr, CLI_COMMIT_PENDING);
+            return CLI_COMMIT_PENDING;
+        }
+        // The staged commands are written before the buffer is published
+        __atomic_store_n(&pending, staging, __ATOMIC_RELEASE);
+        staging ^= 1;
+        return CLI_OK;
+    }
+#endif // CLI_TRANSACTIONS
+
+#ifdef CLI_QUEUE
+    /**
+     * @brief Parse a command onto the queue (queued mode).
+     *
+     * @param i Index of the argument.
+     * @param input Value supplied by the user (nullptr for void arguments).
+     * @return Status of the CLI.
+     */
+    CLI_Status enqueue_arg(uint16_t i, const char* input){
+        CLICommand* cmd = queue.reserve();
+        if(!cmd){
+            overflows = overflows + 1;
+            handle_error(args[i]->get_name(), CLI_QUEUE_FULL);
+            return CLI_QUEUE_FULL;
+        }
+        cmd->arg = i;
+        if(input && !args[i]->stage(input, cmd->value)){
+            handle_error(input, CLI_INVALID_VALUE);
+            return CLI_INVALID_VALUE;
+        }
+        queue.push();
+        return CLI_OK;
+    }
+#endif // CLI_QUEUE
+
+    /**
+     * @brief Are parsed commands applied later (transactional or queued
+     * mode)?
+     *
+     * Commands that would act straight away or over time (`stop`, async
+     * callbacks and the `range`, `loop` and `array` helpers) are then
+     * rejected with `CLI_NOT_STAGEABLE`.
+     */
+    bool deferred(){
+#ifdef CLI_TRANSACTIONS
+        if(transactional){ return true; }
+#endif
+#ifdef CLI_QUEUE
+        if(queued){ return true; }
+#endif
+        return false;
+    }
+
+    /**
+     * @brief Get the next token from the command being parsed.
+     *
+     * Skips leading delimiters, terminates the token in place and moves
+     * `cursor` past it. The position is our own (not `strtok()` state), so
+     * callbacks are free to use `strtok()` and `get_next_value()` can read a
+     * quoted value from the same position.
+     *
+     * @param delims Characters that separate tokens.
+     * @return Next token or nullptr if there are none left.
+     */
+    char* next_token(const char* delims){
+        if(!cursor){ return nullptr; }
+        char* token = cursor + strspn(cursor, delims);
+        if(*token == '\0'){
+            cursor = token;
+            return nullptr;
+        }
+        char* end = token + strcspn(token, delims);
+        if(*end != '\0'){
+            *end++ = '\0';
+        }
+        cursor = end;
+        return token;
+    }
+
+    /**
+     * @brief Get the value that follows an argument.
+     *
+     * With CLI_QUOTED_STRINGS a value wrapped in quotes is returned without
+     * the quotes (and may contain spaces or be empty). An unterminated quote
+     * runs to the end of the line.
+     *
+     * @return Value or nullptr if there are no tokens left.
+     */
+    char* get_next_value(){
+#ifdef CLI_QUOTED_STRINGS
+        // Check if the value is wrapped in quotations
+        if(cursor){
+            cursor += strspn(cursor, " ");
+            if(*cursor == '\"'){
+                char* input = cursor + 1;
+                char* end = strchr(input, '\"');
+                if(end){
+                    *end++ = '\0';
+                } else {
+                    end = input + strlen(input);
+                }
+                cursor = end;
+                return input;
+            }
+        }
+#endif // CLI_QUOTED_STRINGS
+        return next_token(" ");
     }
 
     /**
@@ -593,44 +2344,93 @@ private:
             return CLI_EXPECTED_VALUE_NOT_FOUND;
         }
 
+#ifdef CLI_HELP
         if(strcmp("help", input) == 0){
             help();
             return CLI_HELP_OK;
         }
+#endif
 
-        for(uint8_t i = 0; i < n_args; i++){
-            if(strcmp(args[i]->get_name(), input) == 0){
-                // Void argument, trigger callback with no values
-                if(args[i]->is_void_function()){
-                    args[i]->execute_callback(input);
-                    return CLI_OK;
-                }
+#ifdef CLI_ASYNC
+        if(strcmp("stop", input) == 0){
+            // Would take effect before the rest of the line is applied
+            if(deferred()){
+                handle_error(input, CLI_NOT_STAGEABLE);
+                return CLI_NOT_STAGEABLE;
+            }
+            return stop_tasks(get_next_value());
+        }
+#endif
 
-                // Get the arguments next value
-                input = get_next_value(input);
+        uint16_t i = find_arg(input);
+        if(i == CLI_ARG_NOT_FOUND){
+            handle_error(input, CLI_UNKNOWN_COMMAND);
+            return CLI_UNKNOWN_COMMAND;
+        }
+        Arguments* arg = args[i];
 
-                if(!input){
-                    handle_error(input, CLI_EXPECTED_VALUE_NOT_FOUND);
-                    return CLI_EXPECTED_VALUE_NOT_FOUND;
-                }
+        // Void argument, trigger callback with no values
+        if(arg->is_void_function()){
+#ifdef CLI_ASYNC
+            if(arg->is_async()){
+                return start_task(arg, nullptr);
+            }
+#endif
+#ifdef CLI_TRANSACTIONS
+            if(transactional){
+                return stage_arg(i, nullptr);
+            }
+#endif
+#ifdef CLI_QUEUE
+            if(queued){
+                return enqueue_arg(i, nullptr);
+            }
+#endif
+            execute(arg, input);
+            return CLI_OK;
+        }
 
-                // Check to see if it is a special value
-                #ifdef CLI_RANGE_LOOP
-                if(strcmp("range", input) == 0 || strcmp("loop", input) == 0){
-                    return parse_range_loop(input, args[i]);
-                }
-                if(strcmp("array", input) == 0){
-                    return parse_array_cmd(input, args[i]);
-                }
-                #endif
+        // Get the arguments next value
+        input = get_next_value();
+
+        if(!input){
+            handle_error(input, CLI_EXPECTED_VALUE_NOT_FOUND);
+            return CLI_EXPECTED_VALUE_NOT_FOUND;
+        }
+
+#ifdef CLI_ASYNC
+        if(arg->is_async()){
+            return start_task(arg, input);
+        }
+#endif
 
-                args[i]->execute_callback(input);
-                return CLI_OK;
+        // Check to see if it is a special value
+        #ifdef CLI_RANGE_LOOP
+        if(strcmp("range", input) == 0 || strcmp("loop", input) == 0
+           || strcmp("array", input) == 0){
+            if(deferred()){
+                handle_error(input, CLI_NOT_STAGEABLE);
+                return CLI_NOT_STAGEABLE;
             }
+            if(strcmp("array", input) == 0){
+                return parse_array_cmd(input, arg);
+            }
+            return parse_range_loop(input, arg);
         }
+        #endif
 
-        handle_error(input, CLI_UNKNOWN_COMMAND);
-        return CLI_UNKNOWN_COMMAND;
+#ifdef CLI_TRANSACTIONS
+        if(transactional){
+            return stage_arg(i, input);
+        }
+#endif
+#ifdef CLI_QUEUE
+        if(queued){
+            return enqueue_arg(i, input);
+        }
+#endif
+        execute(arg, input);
+        return CLI_OK;
     }
 
     /**
@@ -644,22 +2444,37 @@ private:
      * @return Should the CLI exit (only if `exit` is passed)
      */
     bool parse_command(char* pCommand){
-        char* input = strtok(pCommand, " ");
+        cursor = pCommand;
+        char* input = next_token(" ");
 
         if(exit(input)){
             memset(cmd_buffer, 0, sizeof(cmd_buffer));
             return true;
         }
 
+#ifdef CLI_TRANSACTIONS
+        n_staged[staging] = 0;
+#endif
+
         while(input){
             if(scan_arg(input) != CLI_OK){
+#ifdef CLI_TRANSACTIONS
+                n_staged[staging] = 0; // Discard the whole line
+#endif
                 goto cmd_complete;
             }
-            input = strtok(nullptr, " ");
+            input = next_token(" ");
+        }
+
+#ifdef CLI_TRANSACTIONS
+        if(transactional){
+            publish_staged();
         }
+#endif
 
         cmd_complete:
-        stream.print("$ ");
+        out(F("$ "));
+        flush();
         memset(cmd_buffer, 0, sizeof(cmd_buffer));
 
         return false;
@@ -671,8 +2486,9 @@ private:
      * @return True if CLI should exit.
      */
     bool exit(const char* input){
-        if(strcmp("exit", input) == 0){
-            stream.println("Exited command line.");
+        if(input && strcmp("exit", input) == 0){
+            out(F("Exited command line.\r\n"));
+            flush();
             return true;
         }
         return false;
@@ -687,17 +2503,101 @@ public:
      * the user provides an `exit` command.
      */
     void enter(){
-        stream.print("$ ");
+        while(!update()) {
+            delay(1);
+        }
+    }
+
+    /**
+     * @brief Non-blocking alternative to `enter()`.
+     *
+     * Reads the bytes that have already arrived, parses at most one complete
+     * command and resumes any async callbacks, then returns. A partially
+     * received line is kept until the rest of it arrives. Call repeatedly,
+     * e.g. from `loop()`.
+     *
+     * @return True if the user provided an `exit` command.
+     */
+    bool update(){
+        if(!prompted){
+            out(F("$ "));
+            flush();
+            prompted = true;
+        }
+
         bool exit = false;
-        while(!exit) {
-            if(stream.available()){
-                stream.readBytesUntil('\n', cmd_buffer, sizeof(cmd_buffer)-1);
-                cmd_buffer[strcspn(cmd_buffer, "\r\n")] = '\0';
-                stream.println(cmd_buffer);
-                exit = parse_command(cmd_buffer);
+        while(stream.available()){
+            if(receive((char)stream.read())){
+                exit = process_line();
+                break;
             }
-            delay(1);
         }
+#ifdef CLI_ASYNC
+        run_tasks();
+#endif
+        return exit;
+    }
+
+    /**
+     * @brief Parse input one character at a time (e.g. as bytes arrive in
+     * `serialEvent()`). Commands are parsed once a newline is fed.
+     *
+     * @param c Character received.
+     * @return True if the user provided an `exit` command.
+     */
+    bool feed(char c){
+        return receive(c) && process_line();
+    }
+
+private:
+    /**
+     * @brief Append a received character to the line in `cmd_buffer`.
+     *
+     * Carriage returns are ignored. Characters beyond the end of the buffer
+     * are dropped and the line is marked as overflowed, so that it is
+     * rejected instead of being parsed truncated (see `process_line()`).
+     *
+     * @param c Character received.
+     * @return True once a newline completes the line.
+     */
+    bool receive(char c){
+        if(c == '\r'){ return false; }
+        if(c != '\n'){
+            if(line_len < sizeof(cmd_buffer) - 1){
+                cmd_buffer[line_len++] = c;
+            } else {
+                line_overflow = true;
+            }
+            return false;
+        }
+        cmd_buffer[line_len] = '\0';
+        line_len = 0;
+        return true;
+    }
+
+    /**
+     * @brief Echo and parse the line in `cmd_buffer`.
+     *
+     * A line that overflowed the buffer is discarded as a whole, parsing
+     * the part that fit could run a different command (e.g. `speed 12345`
+     * cut to `speed 12`).
+     *
+     * @return True if the user provided an `exit` command.
+     */
+    bool process_line(){
+        out(cmd_buffer);
+        out(F("\r\n"));
+        if(line_overflow){
+            line_overflow = false;
+            handle_error(nullptr, CLI_LINE_TOO_LONG);
+            out(F("$ "));
+            flush();
+            prompted = true;
+            return false;
+        }
+        bool exit = parse_command(cmd_buffer);
+        prompted = !exit;
+        return exit;
     }
 };
 
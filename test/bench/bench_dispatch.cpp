@@ -0,0 +1,123 @@
+/*
+ * Command lookup and dispatch with 300 and 1000 arguments, scanning every
+ * argument name (before `build_index()`) compared to the perfect hash index,
+ * over arguments added one by one and over a table added with
+ * `add_arguments()`.
+ *
+ *     ./bench_dispatch [lines]
+ */
+
+#define CLI_HASH_INDEX
+#define CLI_MAX_ARGS 1000
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include <vector>
+#include "bench_util.h"
+
+namespace {
+    volatile int sink = 0;
+    void set(int v){ sink = v; }
+
+    char names[CLI_MAX_ARGS][16];
+
+    //! Average ns per `find_arg()` over every name, `rounds` times
+    double lookup_ns(ArduinoCLI& cli, uint16_t n_args, int rounds){
+        uint64_t start = bench::now_ns();
+        uint32_t found = 0;
+        for(int r = 0; r < rounds; r++){
+            for(uint16_t i = 0; i < n_args; i++){
+                found += cli.find_arg(names[i]) == i;
+            }
+        }
+        uint64_t elapsed = bench::now_ns() - start;
+        if(found != (uint32_t)n_args * rounds){ printf("lookup failed\n"); }
+        return (double)elapsed / ((double)n_args * rounds);
+    }
+
+    //! Parse `lines` commands through update(), timing each call
+    void dispatch(ArduinoCLI& cli, MockStream& stream, uint16_t n_args,
+                  size_t lines, const char* label){
+        for(size_t i = 0; i < lines; i++){
+            // Spread over the whole table (the last names are the slowest
+            // to find by scanning)
+            stream.push(std::string(names[(i * 7919) % n_args]) + " 5\n");
+        }
+        std::vector<uint64_t> latency;
+        latency.reserve(lines);
+        size_t allocations = bench::allocations;
+        uint64_t start = bench::now_ns();
+        for(size_t i = 0; i < lines; i++){
+            uint64_t t0 = bench::now_ns();
+            cli.update();
+            latency.push_back(bench::now_ns() - t0);
+        }
+        uint64_t elapsed = bench::now_ns() - start;
+        allocations = bench::allocations - allocations;
+        printf("  %-7s dispatch: %.0f commands/s, %zu allocations\n", label,
+               (double)lines / ((double)elapsed / 1e9), allocations);
+        char name[32];
+        snprintf(name, sizeof(name), "  %-7s", label);
+        bench::print_latency(name, latency);
+    }
+}
+
+int main(int argc, char** argv){
+    size_t lines = argc > 1 ? strtoul(argv[1], nullptr, 10) : 50000;
+    const uint16_t sizes[] = {300, 1000};
+
+    for(uint16_t n_args : sizes){
+        MockStream stream;
+        stream.capture = false;
+        ArduinoCLI cli(stream);
+        size_t added = bench::allocations;
+        for(uint16_t i = 0; i < n_args; i++){
+            snprintf(names[i], sizeof(names[i]), "motor-%04u", i);
+            cli.add_argument<int>(names[i], "", set);
+        }
+        added = bench::allocations - added;
+        cli.update(); // Prompt
+        int rounds = (int)(lines / n_args) + 1;
+
+        printf("%u arguments\n", n_args);
+        printf("  add_argument: %zu allocations\n", added);
+        printf("  linear  find_arg: %.1f ns\n", lookup_ns(cli, n_args, rounds));
+        dispatch(cli, stream, n_args, lines, "linear");
+
+        size_t allocations = bench::allocations;
+        uint64_t start = bench::now_ns();
+        bool built = cli.build_index();
+        uint64_t build_ns = bench::now_ns() - start;
+        printf("  build_index: %s in %.1f us, %zu allocations\n",
+               built ? "built" : "FAILED", (double)build_ns / 1e3,
+               bench::allocations - allocations);
+
+        printf("  index   find_arg: %.1f ns\n", lookup_ns(cli, n_args, rounds));
+        dispatch(cli, stream, n_args, lines, "index");
+
+        // The same commands as one contiguous table
+        std::vector<CLIEntry> table;
+        table.reserve(n_args);
+        for(uint16_t i = 0; i < n_args; i++){
+            table.emplace_back(names[i], "", set);
+        }
+        MockStream table_stream;
+        table_stream.capture = false;
+        ArduinoCLI table_cli(table_stream);
+        allocations = bench::allocations;
+        start = bench::now_ns();
+        built = table_cli.add_arguments(table.data(), n_args);
+        build_ns = bench::now_ns() - start;
+        printf("  add_arguments: %s in %.1f us, %zu allocations\n",
+               built ? "built" : "FAILED", (double)build_ns / 1e3,
+               bench::allocations - allocations);
+        table_cli.update(); // Prompt
+
+        printf("  table   find_arg: %.1f ns\n",
+               lookup_ns(table_cli, n_args, rounds));
+        dispatch(table_cli, table_stream, n_args, lines, "table");
+    }
+    printf("per argument: Argument<int> %zu bytes (allocated one by one), "
+           "CLIEntry %zu bytes (in one array)\n", sizeof(Argument<int>),
+           sizeof(CLIEntry));
+    return 0;
+}
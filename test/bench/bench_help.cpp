@@ -0,0 +1,58 @@
+/*
+ * Cost of `help` with 50 registered commands: bytes sent, number of writes
+ * to the stream and time per call.
+ *
+ *     ./bench_help [runs]
+ */
+
+#define CLI_HELP
+#define CLI_RANGE_LOOP
+#define CLI_MAX_ARGS 50
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "bench_util.h"
+
+namespace {
+    void noop(int){}
+}
+
+int main(int argc, char** argv){
+    size_t runs = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000;
+
+    static char names[CLI_MAX_ARGS][16];
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    for(uint16_t i = 0; i < CLI_MAX_ARGS; i++){
+        snprintf(names[i], sizeof(names[i]), "command-%02u", i);
+        cli.add_argument<int>(names[i], "Help text for a typical command.",
+                              noop);
+    }
+    cli.update(); // Prompt
+
+    stream.push("help\n");
+    stream.clear_output();
+    cli.update();
+    size_t bytes = stream.bytes_written;
+    size_t writes = stream.write_calls;
+
+    stream.capture = false;
+    std::vector<uint64_t> latency;
+    latency.reserve(runs);
+    uint64_t start = bench::now_ns();
+    for(size_t i = 0; i < runs; i++){
+        stream.push("help\n");
+        uint64_t t0 = bench::now_ns();
+        cli.update();
+        latency.push_back(bench::now_ns() - t0);
+    }
+    uint64_t elapsed = bench::now_ns() - start;
+
+    printf("help with %u commands: %zu bytes in %zu writes "
+           "(CLI_OUT_BUFFER_LEN %u)\n", CLI_MAX_ARGS, bytes, writes,
+           CLI_OUT_BUFFER_LEN);
+    printf("help: %.0f ns per call (%.1f MB/s of output)\n",
+           (double)elapsed / (double)runs,
+           (double)bytes * (double)runs / ((double)elapsed / 1e9) / 1e6);
+    bench::print_latency("help", latency);
+    return 0;
+}
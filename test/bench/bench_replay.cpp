@@ -0,0 +1,62 @@
+/*
+ * Parser throughput over the fuzz corpus (see test/fuzz), in MB/s of input.
+ *
+ * Only feeding the command bytes is timed. Building the CLI and settling
+ * async callbacks at the end are not, and output is counted but not kept.
+ * Inputs using `range`, `loop` or `array` include running those helpers.
+ *
+ *     ./bench_replay <corpus dir> [rounds]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include "../fuzz/corpus.h"
+#include "../fuzz/fuzz_target.h"
+#include "bench_util.h"
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        fprintf(stderr, "usage: %s <corpus dir> [rounds]\n", argv[0]);
+        return 2;
+    }
+    size_t rounds = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+    std::vector<corpus::Input> inputs = corpus::load({argv[1]});
+    if(inputs.empty()){
+        fprintf(stderr, "no inputs in %s\n", argv[1]);
+        return 2;
+    }
+
+    size_t bytes = 0;
+    for(const corpus::Input& input : inputs){ bytes += input.data.size(); }
+
+    std::vector<uint64_t> latency;
+    latency.reserve(rounds * inputs.size());
+    uint64_t start = bench::now_ns();
+    uint64_t feeding = 0;
+    size_t fed = 0;
+    for(size_t r = 0; r < rounds; r++){
+        for(const corpus::Input& input : inputs){
+            const uint8_t* data = (const uint8_t*)input.data.data();
+            size_t first;
+            ClapFuzzSession* session =
+                clap_fuzz_setup(data, input.data.size(), first, false);
+            size_t n = input.data.size() > first ? input.data.size() - first
+                                                 : 0;
+            uint64_t t0 = bench::now_ns();
+            clap_fuzz_feed(session, data + first, n);
+            uint64_t t1 = bench::now_ns();
+            clap_fuzz_finish(session);
+            latency.push_back(t1 - t0);
+            feeding += t1 - t0;
+            fed += n;
+        }
+    }
+    double total = (double)(bench::now_ns() - start) / 1e9;
+    double seconds = (double)feeding / 1e9;
+
+    printf("replay: %zu inputs (%zu bytes) x %zu rounds, %.3f s feeding "
+           "(%.3f s in total) -> %.2f MB/s\n", inputs.size(), bytes, rounds,
+           seconds, total, (double)fed / seconds / 1e6);
+    bench::print_latency("feed per input", latency);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Command throughput of the CLI on the host.
+ *
+ * Replays a mix of typical command lines through `update()` (one command line
+ * per call, timing each call) and through a single `enter()` call, and
+ * reports commands/s, per-command latency percentiles and heap allocations.
+ *
+ *     ./bench_throughput [lines]
+ */
+
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "bench_util.h"
+
+namespace {
+    volatile int32_t sink = 0;
+
+    void led_on(){ sink = sink + 1; }
+    void set_speed(uint16_t v){ sink = v; }
+    void set_pos(int v){ sink = v; }
+    void set_name(const char* v){ sink = (int32_t)strlen(v); }
+
+    const char* const workload[] = {
+        "led-on",
+        "speed 120",
+        "pos -45",
+        "name: sensor",
+        "speed 5 pos 7 led-on",
+        "not-a-command",
+    };
+    const size_t n_workload = sizeof(workload) / sizeof(workload[0]);
+
+    void register_args(ArduinoCLI& cli){
+        cli.add_argument("led-on", "Turn the LED on.", led_on);
+        cli.add_argument<uint16_t>("speed", "Set the speed.", set_speed);
+        cli.add_argument<int>("pos", "Set the position.", set_pos);
+        cli.add_argument<const char*>("name:", "Set the name.", set_name);
+    }
+
+    void push_workload(MockStream& stream, size_t lines){
+        for(size_t i = 0; i < lines; i++){
+            stream.push(std::string(workload[i % n_workload]) + "\n");
+        }
+    }
+
+    void report(const char* label, size_t lines, uint64_t elapsed_ns,
+                size_t allocations, const MockStream& stream){
+        double seconds = (double)elapsed_ns / 1e9;
+        printf("%s: %zu commands in %.3f s -> %.0f commands/s\n", label,
+               lines, seconds, (double)lines / seconds);
+        printf("%s allocations: %zu (%.3f per command)\n", label, allocations,
+               (double)allocations / (double)lines);
+        printf("%s output: %zu bytes in %zu writes\n", label,
+               stream.bytes_written, stream.write_calls);
+    }
+}
+
+int main(int argc, char** argv){
+    size_t lines = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+    {
+        MockStream stream;
+        stream.capture = false;
+        ArduinoCLI cli(stream);
+        register_args(cli);
+        push_workload(stream, lines);
+        cli.update(); // Prompt and first command, not timed
+
+        std::vector<uint64_t> latency;
+        latency.reserve(lines);
+        size_t allocations = bench::allocations;
+        uint64_t start = bench::now_ns();
+        for(size_t i = 1; i < lines; i++){
+            uint64_t t0 = bench::now_ns();
+            cli.update();
+            latency.push_back(bench::now_ns() - t0);
+        }
+        uint64_t elapsed = bench::now_ns() - start;
+        allocations = bench::allocations - allocations;
+
+        report("update()", lines - 1, elapsed, allocations, stream);
+        bench::print_latency("update()", latency);
+    }
+
+    {
+        MockStream stream;
+        stream.capture = false;
+        ArduinoCLI cli(stream);
+        register_args(cli);
+        push_workload(stream, lines);
+        stream.push("exit\n");
+
+        size_t allocations = bench::allocations;
+        uint64_t start = bench::now_ns();
+        cli.enter();
+        uint64_t elapsed = bench::now_ns() - start;
+        allocations = bench::allocations - allocations;
+
+        report("enter()", lines, elapsed, allocations, stream);
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * Helpers shared by the host benchmarks: a wall clock, latency percentiles
+ * and a global allocation counter.
+ *
+ * Include from exactly one translation unit per executable, it replaces the
+ * global `operator new`.
+ */
+
+#ifndef CLAP_BENCH_UTIL_H
+#define CLAP_BENCH_UTIL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace bench {
+    //! Number of calls to `operator new` so far
+    size_t allocations = 0;
+
+    inline uint64_t now_ns(){
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //! Value at percentile `p` (0-100) of `samples`, which is sorted in place
+    inline uint64_t percentile(std::vector<uint64_t>& samples, double p){
+        if(samples.empty()){ return 0; }
+        std::sort(samples.begin(), samples.end());
+        size_t i = (size_t)(p / 100.0 * (double)(samples.size() - 1) + 0.5);
+        return samples[i];
+    }
+
+    //! Print the distribution of `samples` (in ns) on one line
+    inline void print_latency(const char* label, std::vector<uint64_t> samples){
+        printf("%s latency ns: p50 %llu  p90 %llu  p99 %llu  max %llu\n", label,
+               (unsigned long long)percentile(samples, 50),
+               (unsigned long long)percentile(samples, 90),
+               (unsigned long long)percentile(samples, 99),
+               (unsigned long long)percentile(samples, 100));
+    }
+}
+
+// Kept out of line: once inlined, GCC pairs the `new` in the caller with the
+// `free()` here and warns (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t size){
+    bench::allocations++;
+    void* p = malloc(size ? size : 1);
+    if(!p){ throw std::bad_alloc(); }
+    return p;
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+void* operator new[](size_t size){ return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+#endif // CLAP_BENCH_UTIL_H
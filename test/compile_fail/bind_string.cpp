@@ -0,0 +1,14 @@
+/*
+ * Must not compile: a bound string would point into the command buffer.
+ */
+
+#include <Arduino.h>
+#include <arduino_clap.h>
+
+const char* name = nullptr;
+
+int main(){
+    ArduinoCLI cli(Serial);
+    cli.add_argument("name", "Bound string.", &name);
+    return 0;
+}
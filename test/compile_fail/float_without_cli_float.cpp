@@ -0,0 +1,14 @@
+/*
+ * Must not compile: float arguments require CLI_FLOAT.
+ */
+
+#include <Arduino.h>
+#include <arduino_clap.h>
+
+void set_gain(float){}
+
+int main(){
+    ArduinoCLI cli(Serial);
+    cli.add_argument<float>("gain", "Set the gain.", set_gain);
+    return 0;
+}
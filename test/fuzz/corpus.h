@@ -0,0 +1,64 @@
+/*
+ * Loading fuzz inputs from files and directories.
+ */
+
+#ifndef CLAP_FUZZ_CORPUS_H
+#define CLAP_FUZZ_CORPUS_H
+
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace corpus {
+    struct Input {
+        std::string name;
+        std::string data;
+    };
+
+    inline bool read_file(const std::string& path, std::string& data){
+        std::ifstream file(path, std::ios::binary);
+        if(!file){ return false; }
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        data = buffer.str();
+        return true;
+    }
+
+    /**
+     * @brief Load every file named in `paths`, directories are read one
+     * level deep. Inputs are sorted by name so runs are reproducible.
+     */
+    inline std::vector<Input> load(const std::vector<std::string>& paths){
+        std::vector<Input> inputs;
+        for(const std::string& path : paths){
+            struct stat info;
+            if(stat(path.c_str(), &info) != 0){ continue; }
+            if(!S_ISDIR(info.st_mode)){
+                Input input{path, ""};
+                if(read_file(path, input.data)){ inputs.push_back(input); }
+                continue;
+            }
+            DIR* dir = opendir(path.c_str());
+            if(!dir){ continue; }
+            std::vector<std::string> names;
+            while(dirent* entry = readdir(dir)){
+                if(entry->d_name[0] != '.'){ names.push_back(entry->d_name); }
+            }
+            closedir(dir);
+            std::sort(names.begin(), names.end());
+            for(const std::string& name : names){
+                Input input{name, ""};
+                if(read_file(path + "/" + name, input.data)){
+                    inputs.push_back(input);
+                }
+            }
+        }
+        return inputs;
+    }
+}
+
+#endif // CLAP_FUZZ_CORPUS_H
@@ -0,0 +1,141 @@
+/*
+ * Standalone driver for the fuzz target, for compilers without libFuzzer.
+ *
+ * Runs every input once, then (with -runs=N) N randomly mutated inputs built
+ * from them. Build with sanitizers so memory errors abort the run, the input
+ * being run is then written to `crash-input` so it can be replayed. Also
+ * usable with AFL (afl-g++, `fuzz_parse_command @@`).
+ *
+ *     fuzz_parse_command [-runs=N] [-seed=S] [-max_len=L] <file|dir>...
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "corpus.h"
+#include "fuzz_target.h"
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_UNDEFINED__)
+#define CLAP_FUZZ_DEATH_CALLBACK
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+namespace {
+    //! Tokens of the command syntax, spliced into inputs by the mutator
+    const char* const dictionary[] = {
+        " ", "\n", "\r", "\"", ":", ",", "[", "]", "-", ".", "e", "0", "9",
+        "help", "exit", "stop", "range", "loop", "array", "on", "speed",
+        "level", "trim", "small", "offset", "count", "gain", "ratio", "echo",
+        "bound", "blink", "pulse", "65535", "-128", "4294967295", "1e39",
+        "nan", "#!t", "#!q", "#!i",
+    };
+    const size_t n_dictionary = sizeof(dictionary) / sizeof(dictionary[0]);
+
+    struct Mutator {
+        std::mt19937 rng;
+        const std::vector<corpus::Input>& inputs;
+
+        size_t below(size_t n){
+            return n ? std::uniform_int_distribution<size_t>(0, n - 1)(rng) : 0;
+        }
+
+        std::string mutate(std::string data){
+            size_t n = 1 + below(4);
+            for(size_t i = 0; i < n; i++){
+                size_t at = below(data.size() + 1);
+                switch(below(6)){
+                    case 0: // Flip a bit
+                        if(!data.empty()){
+                            data[below(data.size())] ^= (char)(1 << below(8));
+                        }
+                        break;
+                    case 1: // Random byte
+                        data.insert(at, 1, (char)below(256));
+                        break;
+                    case 2: // Dictionary token
+                        data.insert(at, dictionary[below(n_dictionary)]);
+                        break;
+                    case 3: // Erase a range
+                        data.erase(at, below(8));
+                        break;
+                    case 4: // Duplicate a range
+                        data.insert(at, data.substr(below(data.size() + 1),
+                                                    below(16)));
+                        break;
+                    default: { // Splice in part of another input
+                        const std::string& other =
+                            inputs[below(inputs.size())].data;
+                        data.insert(at, other.substr(below(other.size() + 1),
+                                                     below(32)));
+                    }
+                }
+            }
+            return data;
+        }
+    };
+
+    //! Input being run (saved if a sanitizer aborts)
+    const std::string* current = nullptr;
+
+    void save_current(){
+        if(!current){ return; }
+        FILE* file = fopen("crash-input", "wb");
+        if(!file){ return; }
+        fwrite(current->data(), 1, current->size(), file);
+        fclose(file);
+        fprintf(stderr, "input written to crash-input\n");
+    }
+
+    void run(const std::string& data){
+        current = &data;
+        LLVMFuzzerTestOneInput((const uint8_t*)data.data(), data.size());
+        current = nullptr;
+    }
+}
+
+int main(int argc, char** argv){
+    unsigned long runs = 0;
+    unsigned long seed = 1;
+    size_t max_len = 512;
+    std::vector<std::string> paths;
+    for(int i = 1; i < argc; i++){
+        if(strncmp(argv[i], "-runs=", 6) == 0){
+            runs = strtoul(argv[i] + 6, nullptr, 10);
+        } else if(strncmp(argv[i], "-seed=", 6) == 0){
+            seed = strtoul(argv[i] + 6, nullptr, 10);
+        } else if(strncmp(argv[i], "-max_len=", 9) == 0){
+            max_len = strtoul(argv[i] + 9, nullptr, 10);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+#ifdef CLAP_FUZZ_DEATH_CALLBACK
+    __sanitizer_set_death_callback(save_current);
+#endif
+    std::vector<corpus::Input> inputs = corpus::load(paths);
+    if(inputs.empty()){
+        fprintf(stderr, "usage: %s [-runs=N] [-seed=S] [-max_len=L] "
+                        "<file|dir>...\n", argv[0]);
+        return 2;
+    }
+    for(const corpus::Input& input : inputs){
+        run(input.data);
+    }
+    printf("replayed %zu inputs\n", inputs.size());
+
+    Mutator mutator{std::mt19937(seed), inputs};
+    for(unsigned long i = 0; i < runs; i++){
+        std::string data =
+            mutator.mutate(inputs[mutator.below(inputs.size())].data);
+        if(data.size() > max_len){ data.resize(max_len); }
+        run(data);
+        if((i + 1) % 10000 == 0){
+            printf("%lu runs\n", i + 1);
+            fflush(stdout);
+        }
+    }
+    if(runs){ printf("%lu mutated runs (seed %lu)\n", runs, seed); }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Fuzz target: every module enabled and one argument of each supported type.
+ *
+ * The input is fed to the CLI a byte at a time (the same path as `update()`).
+ * If its first line starts with "#!" the line selects modes:
+ *   t  transactional (each line is committed)
+ *   q  queued (the queue is drained after each line)
+ *   i  build the hash index
+ * e.g. "#!ti". Async callbacks are resumed after every line and the virtual
+ * clock advances 1 ms per line. `stop` is always available on the stream, so
+ * `range`, `loop` and `array` end after a couple of iterations.
+ */
+
+#define CLI_FULL
+#define CLI_MAX_ARGS 16
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "fuzz_target.h"
+
+namespace {
+    MockStream* stream = nullptr;
+    int bound = 0;
+
+    void print(const char* name){
+        stream->print(name);
+        stream->print('=');
+    }
+
+    void on(){ stream->println("on"); }
+    void speed(uint16_t v){ print("speed"); stream->println((unsigned)v); }
+    void level(uint8_t v){ print("level"); stream->println((unsigned)v); }
+    void trim(int8_t v){ print("trim"); stream->println((int)v); }
+    void small(int16_t v){ print("small"); stream->println((int)v); }
+    void offset(int32_t v){ print("offset"); stream->println((long)v); }
+    void count(uint32_t v){ print("count"); stream->println((unsigned long)v); }
+    void gain(float v){ print("gain"); stream->println((double)v); }
+    void ratio(double v){ print("ratio"); stream->println(v); }
+    void echo(const char* v){ print("echo"); stream->println(v); }
+
+    CLI_TaskStatus blink(CLITask& task, uint16_t rate){
+        CLI_TASK_BEGIN(task);
+        for(task.counter = 0; task.counter < 3; task.counter++){
+            print("blink");
+            stream->println((unsigned)rate);
+            CLI_TASK_DELAY(task, rate % 8);
+        }
+        CLI_TASK_END(task);
+    }
+
+    CLI_TaskStatus pulse(CLITask& task){
+        CLI_TASK_BEGIN(task);
+        stream->println("pulse");
+        CLI_TASK_YIELD(task);
+        stream->println("pulse");
+        CLI_TASK_END(task);
+    }
+
+    //! Commit, drain and resume everything started by the last line
+    void settle(ArduinoCLI& cli){
+        cli.commit();
+        cli.drain();
+        cli.run_tasks();
+        delay(1);
+    }
+}
+
+struct ClapFuzzSession {
+    MockStream out;
+    ArduinoCLI cli{out};
+};
+
+ClapFuzzSession* clap_fuzz_setup(const uint8_t* data, size_t size,
+                                 size_t& start, bool capture){
+    ArduinoShim::reset_clock();
+    ClapFuzzSession* session = new ClapFuzzSession;
+    MockStream& out = session->out;
+    ArduinoCLI& cli = session->cli;
+    out.capture = capture;
+    out.set_idle_input("x\nx\nstop\n");
+    stream = &out;
+    bound = 0;
+
+    cli.add_argument("on", "Void callback.", on);
+    cli.add_argument<uint16_t>("speed", "uint16_t callback.", speed);
+    cli.add_argument<uint8_t>("level", "uint8_t callback.", level);
+    cli.add_argument<int8_t>("trim", "int8_t callback.", trim);
+    cli.add_argument<int16_t>("small", "int16_t callback.", small);
+    cli.add_argument<int32_t>("offset", "int32_t callback.", offset);
+    cli.add_argument<uint32_t>("count", "uint32_t callback.", count);
+    cli.add_argument<float>("gain", "float callback.", gain);
+    cli.add_argument<double>("ratio", "double callback.", ratio);
+    cli.add_argument<const char*>("echo", "String callback.", echo);
+    cli.add_argument("bound", "Bound int.", &bound);
+    cli.add_argument<uint16_t>("blink", "Async callback.", blink);
+    cli.add_argument("pulse", "Async void callback.", pulse);
+
+    start = 0;
+    if(size >= 2 && data[0] == '#' && data[1] == '!'){
+        for(start = 2; start < size && data[start] != '\n'; start++){
+            switch(data[start]){
+                case 't': cli.set_transactional(true); break;
+                case 'q': cli.set_queued(true); break;
+                case 'i': cli.build_index(); break;
+                default: break;
+            }
+        }
+        start++; // Skip the newline
+    }
+    return session;
+}
+
+void clap_fuzz_feed(ClapFuzzSession* session, const uint8_t* data,
+                    size_t size){
+    for(size_t i = 0; i < size; i++){
+        session->cli.feed((char)data[i]);
+        if(data[i] == '\n'){
+            settle(session->cli);
+        }
+    }
+}
+
+std::string clap_fuzz_finish(ClapFuzzSession* session){
+    session->cli.feed('\n');
+    for(int i = 0; i < 32; i++){
+        settle(session->cli);
+    }
+    session->out.print("bound=");
+    session->out.println(bound);
+    std::string output = session->out.output;
+    stream = nullptr;
+    delete session;
+    return output;
+}
+
+std::string clap_fuzz_run(const uint8_t* data, size_t size){
+    size_t start;
+    ClapFuzzSession* session = clap_fuzz_setup(data, size, start);
+    if(start < size){
+        clap_fuzz_feed(session, data + start, size - start);
+    }
+    return clap_fuzz_finish(session);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size){
+    clap_fuzz_run(data, size);
+    return 0;
+}
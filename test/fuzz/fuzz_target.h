@@ -0,0 +1,42 @@
+/*
+ * Fuzz target over the command parser (see fuzz_parse_command.cpp).
+ */
+
+#ifndef CLAP_FUZZ_TARGET_H
+#define CLAP_FUZZ_TARGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * @brief Parse `data` as command lines and return everything the CLI and the
+ * callbacks wrote.
+ *
+ * The transcript only depends on the input, so it can be recorded and
+ * compared to prove that a change did not alter parsing behaviour.
+ */
+std::string clap_fuzz_run(const uint8_t* data, size_t size);
+
+/**
+ * @brief `clap_fuzz_run()` in phases, so that parsing can be timed on its own
+ * (see bench_replay.cpp).
+ *
+ * - `clap_fuzz_setup()` builds the CLI, applies the "#!" mode line and returns
+ *   the offset of the first command byte in `data`.
+ * - `clap_fuzz_feed()` feeds command bytes, settling after every line.
+ * - `clap_fuzz_finish()` ends the last line, settles until async callbacks
+ *   are done, frees the session and returns the transcript.
+ *
+ * With `capture` false the output is counted but not kept.
+ */
+struct ClapFuzzSession;
+ClapFuzzSession* clap_fuzz_setup(const uint8_t* data, size_t size,
+                                 size_t& start, bool capture = true);
+void clap_fuzz_feed(ClapFuzzSession* session, const uint8_t* data,
+                    size_t size);
+std::string clap_fuzz_finish(ClapFuzzSession* session);
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+#endif // CLAP_FUZZ_TARGET_H
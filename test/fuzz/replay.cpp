@@ -0,0 +1,69 @@
+/*
+ * Differential replay of the fuzz corpus.
+ *
+ * Runs every corpus input through the fuzz target and compares the
+ * transcripts (everything the CLI and callbacks wrote) with a recorded
+ * expectation, so optimisations can be shown not to change behaviour.
+ * Re-record after an intended behaviour change and review the diff.
+ *
+ *     fuzz_replay --check  <expected> <corpus dir>
+ *     fuzz_replay --record <expected> <corpus dir>
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "corpus.h"
+#include "fuzz_target.h"
+
+int main(int argc, char** argv){
+    if(argc != 4 || (strcmp(argv[1], "--check") != 0
+                     && strcmp(argv[1], "--record") != 0)){
+        fprintf(stderr, "usage: %s --check|--record <expected> <corpus dir>\n",
+                argv[0]);
+        return 2;
+    }
+    bool record = strcmp(argv[1], "--record") == 0;
+
+    std::vector<corpus::Input> inputs = corpus::load({argv[3]});
+    if(inputs.empty()){
+        fprintf(stderr, "no inputs in %s\n", argv[3]);
+        return 2;
+    }
+
+    std::string transcript;
+    for(const corpus::Input& input : inputs){
+        transcript += "=== " + input.name + "\n";
+        transcript += clap_fuzz_run((const uint8_t*)input.data.data(),
+                                    input.data.size());
+        transcript += "\n";
+    }
+
+    if(record){
+        FILE* file = fopen(argv[2], "wb");
+        if(!file){ perror(argv[2]); return 1; }
+        fwrite(transcript.data(), 1, transcript.size(), file);
+        fclose(file);
+        printf("recorded %zu inputs to %s\n", inputs.size(), argv[2]);
+        return 0;
+    }
+
+    std::string expected;
+    if(!corpus::read_file(argv[2], expected)){
+        fprintf(stderr, "cannot read %s\n", argv[2]);
+        return 1;
+    }
+    if(transcript != expected){
+        size_t at = 0;
+        while(at < transcript.size() && at < expected.size()
+              && transcript[at] == expected[at]){
+            at++;
+        }
+        size_t line = 1;
+        for(size_t i = 0; i < at; i++){ line += expected[i] == '\n'; }
+        fprintf(stderr, "transcript differs from %s at line %zu\n", argv[2],
+                line);
+        return 1;
+    }
+    printf("%zu inputs match %s\n", inputs.size(), argv[2]);
+    return 0;
+}
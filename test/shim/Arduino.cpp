@@ -0,0 +1,37 @@
+#include <Arduino.h>
+
+HardwareSerial Serial;
+
+namespace {
+    uint64_t clock_us = 0;
+    uint8_t pin_state[ARDUINO_SHIM_PINS]{};
+    uint32_t pin_changes[ARDUINO_SHIM_PINS]{};
+}
+
+uint32_t millis(){ return (uint32_t)(clock_us / 1000); }
+uint32_t micros(){ return (uint32_t)clock_us; }
+void delay(uint32_t ms){ clock_us += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us){ clock_us += us; }
+void yield(){}
+
+void pinMode(uint8_t, uint8_t){}
+
+void digitalWrite(uint8_t pin, uint8_t val){
+    if(pin >= ARDUINO_SHIM_PINS){ return; }
+    val = val ? HIGH : LOW;
+    if(pin_state[pin] != val){ pin_changes[pin]++; }
+    pin_state[pin] = val;
+}
+
+int digitalRead(uint8_t pin){
+    return pin < ARDUINO_SHIM_PINS ? pin_state[pin] : LOW;
+}
+
+namespace ArduinoShim {
+    uint64_t now_us(){ return clock_us; }
+    void advance_us(uint64_t us){ clock_us += us; }
+    void reset_clock(){ clock_us = 0; }
+    uint32_t pin_toggles(uint8_t pin){
+        return pin < ARDUINO_SHIM_PINS ? pin_changes[pin] : 0;
+    }
+}
@@ -0,0 +1,284 @@
+/*
+ * Minimal Arduino core for building arduino-clap on a host (Linux) machine.
+ *
+ * Provides just enough of the Arduino API for the library, its examples,
+ * tests and benchmarks:
+ *   - a virtual clock (`millis()`, `micros()`, `delay()` never sleep, they
+ *     advance the clock),
+ *   - digital pins that remember their last written state,
+ *   - `Print`/`Stream` and a scriptable `MockStream` used as `Serial`.
+ *
+ * `ARDUINO` is deliberately not defined, so host-only code in the library
+ * (e.g. `FileStorage`) is enabled.
+ */
+
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <deque>
+#include <string>
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LED_BUILTIN 13
+#define BUILTIN_LED LED_BUILTIN
+#define ARDUINO_SHIM_PINS 64
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+class __FlashStringHelper;
+#define F(string_literal) \
+    (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+namespace ArduinoShim {
+    //! Current time of the virtual clock in microseconds
+    uint64_t now_us();
+    //! Move the virtual clock forward
+    void advance_us(uint64_t us);
+    //! Reset the virtual clock to zero
+    void reset_clock();
+    //! Number of times `digitalWrite()` changed the state of a pin
+    uint32_t pin_toggles(uint8_t pin);
+}
+
+/**
+ * @brief Output half of the Arduino stream API.
+ */
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t* buffer, size_t size){
+        size_t n = 0;
+        while(size--){ n += write(*buffer++); }
+        return n;
+    }
+
+    size_t write(const char* str){
+        return str ? write((const uint8_t*)str, strlen(str)) : 0;
+    }
+
+    size_t print(const char* str){ return write(str); }
+    size_t print(const __FlashStringHelper* str){
+        return write(reinterpret_cast<const char*>(str));
+    }
+    size_t print(char c){ return write((uint8_t)c); }
+    size_t print(int v){ return print_fmt("%d", v); }
+    size_t print(unsigned int v){ return print_fmt("%u", v); }
+    size_t print(long v){ return print_fmt("%ld", v); }
+    size_t print(unsigned long v){ return print_fmt("%lu", v); }
+    size_t print(double v, int digits = 2){
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", digits, v);
+        return write(buf);
+    }
+
+    size_t println(){ return write("\r\n"); }
+    template<typename T>
+    size_t println(T v){ size_t n = print(v); return n + println(); }
+
+private:
+    template<typename T>
+    size_t print_fmt(const char* fmt, T v){
+        char buf[24];
+        snprintf(buf, sizeof(buf), fmt, v);
+        return write(buf);
+    }
+};
+
+/**
+ * @brief Input half of the Arduino stream API.
+ *
+ * Timeouts use the virtual clock, so a blocking read that times out only
+ * moves the clock forward.
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout){ timeout_ms = timeout; }
+
+    size_t readBytesUntil(char terminator, char* buffer, size_t length){
+        size_t index = 0;
+        while(index < length){
+            int c = timed_read();
+            if(c < 0 || c == terminator){ break; }
+            buffer[index++] = (char)c;
+        }
+        return index;
+    }
+
+    size_t readBytes(char* buffer, size_t length){
+        size_t index = 0;
+        while(index < length){
+            int c = timed_read();
+            if(c < 0){ break; }
+            buffer[index++] = (char)c;
+        }
+        return index;
+    }
+
+protected:
+    unsigned long timeout_ms = 1000;
+
+    int timed_read(){
+        uint32_t start = millis();
+        do {
+            int c = read();
+            if(c >= 0){ return c; }
+            delay(1);
+        } while(millis() - start < timeout_ms);
+        return -1;
+    }
+};
+
+/**
+ * @brief Scriptable stream for host builds.
+ *
+ * Input is queued with `push()` (available immediately) or `schedule()`
+ * (available once the virtual clock reaches the given time). When the script
+ * runs out, an optional idle input is repeated forever. Everything written is
+ * counted and, unless `capture` is false, appended to `output`.
+ */
+class MockStream : public Stream {
+public:
+    //! Everything written to the stream (if `capture` is true)
+    std::string output;
+    //! Record written bytes in `output`
+    bool capture = true;
+    //! Number of calls to `write()`
+    size_t write_calls = 0;
+    //! Number of bytes written
+    size_t bytes_written = 0;
+
+    //! Queue input that is available immediately
+    void push(const std::string& data){ schedule(0, data); }
+
+    //! Queue input that becomes available at `at_ms` on the virtual clock
+    void schedule(uint32_t at_ms, const std::string& data){
+        if(!data.empty()){ script.push_back(Chunk{at_ms, data}); }
+    }
+
+    //! Input repeated whenever the script is empty (e.g. "stop\n")
+    void set_idle_input(const std::string& data){
+        idle = data;
+        idle_pos = 0;
+    }
+
+    //! Drop all queued input
+    void clear_input(){
+        script.clear();
+        chunk_pos = 0;
+    }
+
+    //! Forget all output and write counters
+    void clear_output(){
+        output.clear();
+        write_calls = 0;
+        bytes_written = 0;
+    }
+
+    //! Number of queued bytes, including those not yet due
+    size_t pending_input() const {
+        size_t n = 0;
+        for(const Chunk& chunk : script){ n += chunk.data.size(); }
+        return n - chunk_pos;
+    }
+
+    int available() override {
+        if(!script.empty()){
+            const Chunk& chunk = script.front();
+            if(chunk.at_ms > millis()){ return 0; }
+            return (int)(chunk.data.size() - chunk_pos);
+        }
+        return (int)(idle.size() - idle_pos);
+    }
+
+    int peek() override {
+        if(!available()){ return -1; }
+        if(!script.empty()){ return (uint8_t)script.front().data[chunk_pos]; }
+        return (uint8_t)idle[idle_pos];
+    }
+
+    int read() override {
+        int c = peek();
+        if(c < 0){ return c; }
+        if(!script.empty()){
+            if(++chunk_pos == script.front().data.size()){
+                script.pop_front();
+                chunk_pos = 0;
+            }
+        } else if(++idle_pos == idle.size()){
+            idle_pos = 0;
+        }
+        return c;
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        write_calls++;
+        bytes_written += size;
+        if(capture){ output.append((const char*)buffer, size); }
+        return size;
+    }
+
+    using Print::write;
+
+private:
+    struct Chunk {
+        uint32_t at_ms;
+        std::string data;
+    };
+
+    std::deque<Chunk> script;
+    size_t chunk_pos = 0;
+    std::string idle;
+    size_t idle_pos = 0;
+};
+
+/**
+ * @brief `Serial` is a `MockStream` on the host.
+ */
+class HardwareSerial : public MockStream {
+public:
+    void begin(unsigned long){}
+    void end(){}
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_SHIM_H
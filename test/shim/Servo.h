@@ -0,0 +1,22 @@
+#ifndef SERVO_SHIM_H
+#define SERVO_SHIM_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Host stand-in for the Arduino Servo library.
+ */
+class Servo {
+public:
+    uint8_t attach(int pin){ attached_pin = pin; return 0; }
+    void detach(){ attached_pin = -1; }
+    void write(int value){ position = value; }
+    int read(){ return position; }
+    bool attached(){ return attached_pin >= 0; }
+
+private:
+    int attached_pin = -1;
+    int position = 90;
+};
+
+#endif // SERVO_SHIM_H
@@ -0,0 +1,27 @@
+/*
+ * Runs an unmodified example sketch on the host.
+ *
+ * Each command line argument is typed into `Serial` as one line, followed by
+ * `exit` so `ArduinoCLI::enter()` returns. `setup()` and one `loop()` are
+ * then run and everything the sketch wrote is printed to stdout.
+ *
+ *     ./example_blinky_dynamic "blink-dyn 50"
+ */
+
+#include <Arduino.h>
+
+void setup();
+void loop();
+
+int main(int argc, char** argv){
+    for(int i = 1; i < argc; i++){
+        Serial.push(std::string(argv[i]) + "\n");
+    }
+    Serial.push("exit\n");
+
+    setup();
+    loop();
+
+    fwrite(Serial.output.data(), 1, Serial.output.size(), stdout);
+    return 0;
+}
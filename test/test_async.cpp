@@ -0,0 +1,118 @@
+/*
+ * Input stays responsive while many async callbacks run: commands are
+ * executed on the first `update()` after their newline arrives, and
+ * `stop blink` cancels running callbacks while others keep going.
+ */
+
+#define CLI_ASYNC
+#define CLI_MAX_TASKS 16
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "test_util.h"
+
+namespace {
+    const uint8_t first_pin = 2;
+    const uint8_t n_blink = 12;
+    const uint8_t n_work = 3;
+
+    uint32_t work_steps = 0;
+    int last_set = 0;
+    uint32_t set_at = 0;
+
+    CLI_TaskStatus blink(CLITask& task, uint8_t pin){
+        CLI_TASK_BEGIN(task);
+        while(true){
+            digitalWrite(pin, HIGH);
+            CLI_TASK_DELAY(task, 5);
+            digitalWrite(pin, LOW);
+            CLI_TASK_DELAY(task, 5);
+        }
+        CLI_TASK_END(task);
+    }
+
+    CLI_TaskStatus work(CLITask& task){
+        CLI_TASK_BEGIN(task);
+        while(true){
+            work_steps++;
+            CLI_TASK_YIELD(task);
+        }
+        CLI_TASK_END(task);
+    }
+
+    void set(int v){
+        last_set = v;
+        set_at = millis();
+    }
+
+    uint32_t blink_toggles(){
+        uint32_t n = 0;
+        for(uint8_t i = 0; i < n_blink; i++){
+            n += ArduinoShim::pin_toggles(first_pin + i);
+        }
+        return n;
+    }
+
+    //! Call update() once per virtual millisecond until `until_ms`
+    void run_until(ArduinoCLI& cli, uint32_t until_ms){
+        while(millis() < until_ms){
+            cli.update();
+            delay(1);
+        }
+    }
+
+    //! Type `line` one character per millisecond starting at `at_ms`
+    void type(MockStream& stream, uint32_t at_ms, const char* line){
+        for(; *line; line++, at_ms++){
+            stream.schedule(at_ms, std::string(1, *line));
+        }
+    }
+}
+
+int main(){
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    cli.add_argument<uint8_t>("blink", "Blink a pin.", blink);
+    cli.add_argument("work", "Background work.", work);
+    cli.add_argument<int>("set", "Set a value.", set);
+
+    for(uint8_t i = 0; i < n_blink; i++){
+        stream.push("blink " + std::to_string(first_pin + i) + "\n");
+    }
+    for(uint8_t i = 0; i < n_work; i++){
+        stream.push("work\n");
+    }
+    run_until(cli, 50);
+    CHECK(!test::contains(stream.output, "Too many running functions"));
+    for(uint8_t i = 0; i < n_blink; i++){
+        CHECK(ArduinoShim::pin_toggles(first_pin + i) > 0); // Every blink runs
+    }
+    CHECK(work_steps > 0);
+
+    // A command arriving while every task runs is executed immediately
+    stream.schedule(100, "set 1\n");
+    run_until(cli, 150);
+    CHECK(last_set == 1);
+    CHECK(set_at == 100);
+
+    // Typed one character at a time, tasks keep running between characters
+    uint32_t toggles = blink_toggles();
+    uint32_t steps = work_steps;
+    type(stream, 200, "stop blink\n");
+    run_until(cli, 210);
+    CHECK(blink_toggles() > toggles);
+    CHECK(work_steps > steps);
+
+    run_until(cli, 212);
+    toggles = blink_toggles();
+    steps = work_steps;
+    run_until(cli, 300);
+    CHECK(blink_toggles() == toggles); // Every blink was cancelled
+    CHECK(work_steps > steps);         // Other callbacks keep running
+
+    type(stream, 300, "set 2\n");
+    run_until(cli, 320);
+    CHECK(last_set == 2);
+    CHECK(set_at == 305);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,94 @@
+/*
+ * Lookups through the perfect hash index, and the fallback to scanning every
+ * argument when the index is missing or out of date. Tables of arguments
+ * registered in one go with add_arguments().
+ */
+
+#define CLI_HASH_INDEX
+#define CLI_MAX_ARGS 300
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "test_util.h"
+
+namespace {
+    int last = -1;
+    int ons = 0;
+    uint8_t level = 0;
+    char label[8]{};
+    void set(int v){ last = v; }
+    void on(){ ons++; }
+    void set_label(const char* v){ strncpy(label, v, sizeof(label) - 1); }
+
+    char names[CLI_MAX_ARGS][16];
+
+    CLIEntry table[] = {
+        {"on", "Void callback.", on},
+        {"set", "int callback.", set},
+        {"level", "Bound uint8_t.", &level},
+        {"label", "String callback.", set_label},
+    };
+}
+
+int main(){
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    for(uint16_t i = 0; i < CLI_MAX_ARGS - 1; i++){
+        snprintf(names[i], sizeof(names[i]), "arg-%u", i);
+        cli.add_argument<int>(names[i], "", set);
+    }
+
+    // Not built yet, names are still found
+    CHECK(cli.find_arg("arg-17") == 17);
+
+    CHECK(cli.build_index());
+    bool all_found = true;
+    for(uint16_t i = 0; i < CLI_MAX_ARGS - 1; i++){
+        all_found = all_found && cli.find_arg(names[i]) == i;
+    }
+    CHECK(all_found);
+    CHECK(cli.find_arg("arg-17x") == CLI_ARG_NOT_FOUND);
+    CHECK(cli.find_arg("") == CLI_ARG_NOT_FOUND);
+
+    // Adding an argument discards the index, the new one is still found
+    cli.add_argument<int>("late", "", set);
+    CHECK(cli.find_arg("late") == CLI_MAX_ARGS - 1);
+    CHECK(cli.find_arg("arg-5") == 5);
+    stream.push("late 3\n");
+    cli.update();
+    CHECK(last == 3);
+    CHECK(cli.build_index());
+    CHECK(cli.find_arg("late") == CLI_MAX_ARGS - 1);
+
+    // Duplicate names cannot be indexed, lookups scan instead
+    MockStream stream2;
+    ArduinoCLI dup(stream2);
+    dup.add_argument<int>("same", "", set);
+    dup.add_argument<int>("other", "", set);
+    dup.add_argument<int>("same", "", set);
+    CHECK(!dup.build_index());
+    CHECK(dup.find_arg("same") == 0);
+    CHECK(dup.find_arg("other") == 1);
+
+    // A table is registered in one go and indexed
+    MockStream stream3;
+    ArduinoCLI tabled(stream3);
+    CHECK(tabled.add_arguments(table));
+    CHECK(tabled.find_arg("level") == 2);
+    CHECK(tabled.find_arg("lev") == CLI_ARG_NOT_FOUND);
+    stream3.push("on set 7 level 9 label abc\n");
+    tabled.update();
+    CHECK(ons == 1 && last == 7 && level == 9);
+    CHECK(strcmp(label, "abc") == 0);
+
+    // Mixed with arguments added one by one
+    tabled.add_argument<int>("single", "", set);
+    CHECK(tabled.find_arg("single") == 4);
+    CHECK(tabled.build_index());
+    CHECK(tabled.find_arg("label") == 3);
+
+    // Entries beyond CLI_MAX_ARGS are left out (and never freed)
+    CHECK(!cli.add_arguments(table));
+    CHECK(cli.find_arg("on") == CLI_ARG_NOT_FOUND);
+
+    return TEST_RESULT();
+}
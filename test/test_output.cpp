@@ -0,0 +1,49 @@
+/*
+ * Number of writes to the stream per response.
+ */
+
+#define CLI_HELP
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "test_util.h"
+
+namespace {
+    MockStream stream;
+
+    void quiet(int){}
+    void loud(int v){ stream.print("value "); stream.println(v); }
+
+    //! Send one line and return the number of writes it caused
+    size_t writes_for(ArduinoCLI& cli, const char* line){
+        stream.push(std::string(line) + "\n");
+        stream.clear_output();
+        cli.update();
+        return stream.write_calls;
+    }
+}
+
+int main(){
+    ArduinoCLI cli(stream);
+    cli.add_argument<int>("quiet", "Callback without output.", quiet);
+    cli.add_argument<int>("loud", "Callback with output.", loud);
+    cli.update(); // Prompt
+
+    // Echo, error and prompt in one write
+    CHECK(writes_for(cli, "bogus") == 1);
+    CHECK(stream.output == "bogus\r\nUnknown command: bogus\r\n$ ");
+    CHECK(writes_for(cli, "quiet") == 1);
+    CHECK(test::contains(stream.output, "Expected value not found."));
+
+    // Pending output is written before a callback runs, then the prompt
+    CHECK(writes_for(cli, "quiet 1") == 2);
+    CHECK(writes_for(cli, "quiet 1 quiet 2") == 2);
+    writes_for(cli, "loud 5");
+    CHECK(stream.output == "loud 5\r\nvalue 5\r\n$ ");
+
+    // Help fits in ceil(length / CLI_OUT_BUFFER_LEN) writes
+    size_t writes = writes_for(cli, "help");
+    CHECK(writes == (stream.bytes_written + CLI_OUT_BUFFER_LEN - 1) /
+                    CLI_OUT_BUFFER_LEN);
+
+    return TEST_RESULT();
+}
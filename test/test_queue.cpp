@@ -0,0 +1,134 @@
+/*
+ * Queued mode: commands parsed on one thread are executed in order by
+ * drain() on another, overflows are counted, and commands that cannot be
+ * queued are rejected. Prints the throughput of the threaded run.
+ *
+ *     ./test_queue [commands]
+ */
+
+#define CLI_QUEUE
+#define CLI_ASYNC
+#define CLI_RANGE_LOOP
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "test_util.h"
+
+namespace {
+    std::vector<int> seen;
+
+    void set(int v){ seen.push_back(v); }
+    void msg(const char* m){ seen.push_back(-(int)strlen(m)); }
+
+    CLI_TaskStatus spin(CLITask& task){
+        CLI_TASK_BEGIN(task);
+        CLI_TASK_YIELD(task);
+        CLI_TASK_END(task);
+    }
+
+    void feed_line(ArduinoCLI& cli, const char* line){
+        for(; *line; line++){ cli.feed(*line); }
+        cli.feed('\n');
+    }
+
+    uint64_t now_ns(){
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+int main(int argc, char** argv){
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    cli.add_argument<int>("set", "", set);
+    cli.add_argument<const char*>("msg", "", msg);
+    cli.add_argument("spin", "", spin);
+    cli.set_queued(true);
+
+    // Commands beyond the queue length are dropped and counted
+    char line[32];
+    for(int i = 0; i < CLI_QUEUE_LEN + 2; i++){
+        snprintf(line, sizeof(line), "set %d", i);
+        feed_line(cli, line);
+    }
+    CHECK(cli.queued_commands() == CLI_QUEUE_LEN);
+    CHECK(cli.queue_overflows() == 2);
+    CHECK(test::contains(stream.output, "Command queue full, dropped: set"));
+    CHECK(cli.drain(3) == 3);
+    CHECK(cli.drain() == CLI_QUEUE_LEN - 3);
+    bool in_order = seen.size() == CLI_QUEUE_LEN;
+    for(int i = 0; in_order && i < CLI_QUEUE_LEN; i++){
+        in_order = seen[i] == i;
+    }
+    CHECK(in_order);
+
+    // Commands that act immediately or over time cannot be queued
+    const char* const rejected[] = {
+        "set range 0:5:1", "set loop 0:5:1", "set array 1:[1, 2]",
+        "spin", "stop", "stop spin",
+    };
+    for(const char* cmd : rejected){
+        stream.clear_output();
+        feed_line(cli, cmd);
+        CHECK(test::contains(stream.output, "Cannot be staged: "));
+    }
+
+    // Invalid values and strings that do not fit are reported, not truncated
+    stream.clear_output();
+    feed_line(cli, "set abc");
+    feed_line(cli, "msg 0123456789abcdef");
+    CHECK(test::contains(stream.output, "Invalid value: abc"));
+    CHECK(test::contains(stream.output, "Invalid value: 0123456789abcdef"));
+    CHECK(cli.queued_commands() == 0);
+
+    // Producer and consumer on separate threads
+    seen.clear();
+    stream.capture = false;
+    const int n = argc > 1 ? atoi(argv[1]) : 20000;
+    seen.reserve(n);
+    std::atomic<bool> done{false};
+    uint64_t start = now_ns();
+    std::thread producer([&]{
+        char buf[32];
+        for(int i = 0; i < n;){
+            if(cli.queued_commands() >= CLI_QUEUE_LEN){
+                std::this_thread::yield();
+                continue;
+            }
+            if(i % 1000 == 0){
+                snprintf(buf, sizeof(buf), "msg hello");
+            } else {
+                snprintf(buf, sizeof(buf), "set %d", i);
+            }
+            feed_line(cli, buf);
+            i++;
+        }
+        done = true;
+    });
+    std::thread consumer([&]{
+        while(!done || cli.queued_commands()){
+            if(!cli.drain(4)){
+                std::this_thread::yield();
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+    double seconds = (double)(now_ns() - start) / 1e9;
+    printf("queue: %d commands parsed and drained across threads in %.3f s "
+           "-> %.0f commands/s\n", n, seconds, (double)n / seconds);
+
+    CHECK(seen.size() == (size_t)n);
+    in_order = seen.size() == (size_t)n;
+    for(int i = 0; in_order && i < n; i++){
+        in_order = seen[i] == (i % 1000 == 0 ? -5 : i);
+    }
+    CHECK(in_order);
+    CHECK(cli.queue_overflows() == 2);
+
+    return TEST_RESULT();
+}
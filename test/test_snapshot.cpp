@@ -0,0 +1,171 @@
+/*
+ * Snapshots of bound arguments saved to and restored from a file, and the
+ * time a restore takes compared to typing the same values back in.
+ */
+
+#define CLI_SNAPSHOT
+#define CLI_FLOAT
+#define CLI_MAX_ARGS 300
+#define CLI_SNAPSHOT_SLOT_SIZE 2048 // Room for more than 255 values
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include <chrono>
+#include "test_util.h"
+
+namespace {
+    const char* const path = "test_snapshot.bin";
+    const uint8_t n_vars = 12;
+
+    int32_t vars[n_vars]{};
+    float gain = 0;
+
+    void register_args(ArduinoCLI& cli, char names[][8]){
+        for(uint8_t i = 0; i < n_vars; i++){
+            snprintf(names[i], 8, "var-%02u", i);
+            cli.add_argument(names[i], "Bound variable.", &vars[i]);
+        }
+        cli.add_argument("gain", "Bound float.", &gain);
+    }
+
+    //! Storage in RAM, to separate the cost of restore() from file I/O
+    class MemoryStorage : public CLIStorage {
+    public:
+        uint8_t data[4 * CLI_SNAPSHOT_SLOT_SIZE];
+        size_t slots = 4;
+        size_t length() override { return slots * CLI_SNAPSHOT_SLOT_SIZE; }
+        void read(size_t address, uint8_t* dst, size_t len) override {
+            memcpy(dst, data + address, len);
+        }
+        void write(size_t address, const uint8_t* src, size_t len) override {
+            memcpy(data + address, src, len);
+        }
+    };
+
+    uint64_t now_ns(){
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+int main(){
+    remove(path);
+    char names[n_vars][8];
+    std::string commands;
+
+    {
+        FileStorage storage(path, 4 * CLI_SNAPSHOT_SLOT_SIZE);
+        CHECK(storage.is_open());
+        CHECK(storage.length() == 4 * CLI_SNAPSHOT_SLOT_SIZE);
+
+        MockStream stream;
+        ArduinoCLI cli(stream);
+        register_args(cli, names);
+        CHECK(!cli.restore(storage)); // Erased storage
+
+        for(uint8_t i = 0; i < n_vars; i++){
+            commands += std::string(names[i]) + " " +
+                        std::to_string(1000 * i - 5000) + "\n";
+        }
+        commands += "gain 2.5\n";
+        stream.push(commands);
+        while(stream.pending_input()){ cli.update(); }
+        CHECK(vars[3] == -2000);
+        CHECK(gain == 2.5f);
+
+        // Several saves rotate through the slots, the last one wins
+        for(int i = 0; i < 5; i++){
+            vars[0] = i;
+            CHECK(cli.save(storage));
+        }
+    }
+
+    // Restore from the file in a fresh CLI
+    memset(vars, 0, sizeof(vars));
+    gain = 0;
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    register_args(cli, names);
+    FileStorage storage(path, 4 * CLI_SNAPSHOT_SLOT_SIZE);
+
+    const int runs = 1000;
+    uint64_t start = now_ns();
+    bool restored = true;
+    for(int i = 0; i < runs; i++){
+        restored = cli.restore(storage) && restored;
+    }
+    uint64_t restore_ns = (now_ns() - start) / runs;
+    CHECK(restored);
+    CHECK(vars[0] == 4);
+    CHECK(vars[11] == 6000);
+    CHECK(gain == 2.5f);
+
+    MemoryStorage memory;
+    storage.read(0, memory.data, sizeof(memory.data));
+    start = now_ns();
+    for(int i = 0; i < runs; i++){
+        restored = cli.restore(memory) && restored;
+    }
+    uint64_t memory_ns = (now_ns() - start) / runs;
+    CHECK(restored);
+
+    // The same values sent as commands
+    stream.capture = false;
+    start = now_ns();
+    for(int i = 0; i < runs; i++){
+        stream.push(commands);
+        while(stream.pending_input()){ cli.update(); }
+    }
+    uint64_t replay_ns = (now_ns() - start) / runs;
+    CHECK(vars[0] == -5000);
+
+    printf("restore of %u values: %llu ns (file), %llu ns (memory), "
+           "replaying commands: %llu ns\n", n_vars + 1,
+           (unsigned long long)restore_ns, (unsigned long long)memory_ns,
+           (unsigned long long)replay_ns);
+
+    // A corrupted newest snapshot falls back to the previous one
+    size_t newest = 0;
+    uint16_t newest_sequence = 0;
+    for(size_t slot = 0; slot < 4; slot++){
+        CLISnapshotHeader header;
+        storage.read(slot * CLI_SNAPSHOT_SLOT_SIZE, (uint8_t*)&header,
+                     sizeof(header));
+        if(header.magic == CLI_SNAPSHOT_MAGIC &&
+           (int16_t)(header.sequence - newest_sequence) > 0){
+            newest = slot * CLI_SNAPSHOT_SLOT_SIZE;
+            newest_sequence = header.sequence;
+        }
+    }
+    uint8_t byte;
+    storage.read(newest + sizeof(CLISnapshotHeader), &byte, 1);
+    byte ^= 0xFF;
+    storage.write(newest + sizeof(CLISnapshotHeader), &byte, 1);
+    CHECK(cli.restore(storage));
+    CHECK(vars[0] == 3);
+
+    // A single slot would be overwritten in place, so it is rejected
+    memory.slots = 1;
+    CHECK(!cli.save(memory));
+    memory.slots = 4;
+
+    // The header counts at most 255 values
+    static uint8_t many[256];
+    static char many_names[256][8];
+    MockStream many_stream;
+    ArduinoCLI many_cli(many_stream);
+    for(uint16_t i = 0; i < 255; i++){
+        snprintf(many_names[i], 8, "m-%03u", i);
+        many_cli.add_argument(many_names[i], "Bound byte.", &many[i]);
+        many[i] = (uint8_t)i;
+    }
+    CHECK(many_cli.save(memory));
+    snprintf(many_names[255], 8, "m-255");
+    many_cli.add_argument(many_names[255], "Bound byte.", &many[255]);
+    CHECK(!many_cli.save(memory));
+    memset(many, 0, sizeof(many));
+    CHECK(many_cli.restore(memory)); // The 255 value snapshot is kept
+    CHECK(many[254] == 254);
+
+    remove(path);
+    return TEST_RESULT();
+}
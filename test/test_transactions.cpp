@@ -0,0 +1,137 @@
+/*
+ * Transactional mode: a line is applied as a whole by commit(), and any
+ * invalid value discards the whole line. commit() may run in another context
+ * (here another thread) than the parser.
+ */
+
+#define CLI_TRANSACTIONS
+#define CLI_ASYNC
+#define CLI_FLOAT
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include <atomic>
+#include <thread>
+#include "test_util.h"
+
+namespace {
+    uint16_t speed = 100;
+    float dir = 0;
+    int8_t trim = 0;
+    char label[CLI_VALUE_LEN]{};
+    uint16_t left = 0;
+    uint16_t right = 0;
+    int16_t table_value = 0;
+    int table_calls = 0;
+
+    void table_set(int16_t v){ table_value = v; table_calls++; }
+
+    CLIEntry table[] = {
+        {"t-set", "Table callback.", table_set},
+        {"t-dir", "Table bound float.", &dir},
+    };
+    uint32_t spins = 0;
+
+    void set_label(const char* v){ strcpy(label, v); }
+
+    CLI_TaskStatus spin(CLITask& task){
+        CLI_TASK_BEGIN(task);
+        while(true){
+            spins++;
+            CLI_TASK_YIELD(task);
+        }
+        CLI_TASK_END(task);
+    }
+
+    //! Send a line and commit it, returns true if anything was applied
+    bool apply(ArduinoCLI& cli, MockStream& stream, const char* line){
+        stream.push(std::string(line) + "\n");
+        stream.clear_output();
+        cli.update();
+        return cli.commit();
+    }
+}
+
+int main(){
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    cli.add_argument("speed", "Bound uint16_t.", &speed);
+    cli.add_argument("dir", "Bound float.", &dir);
+    cli.add_argument("trim", "Bound int8_t.", &trim);
+    cli.add_argument<const char*>("label", "String callback.", set_label);
+    cli.add_argument("spin", "Async callback.", spin);
+
+    stream.push("spin\n");
+    cli.update();
+    cli.set_transactional(true);
+
+    CHECK(apply(cli, stream, "speed 5 dir 2.5 trim -3 label abc"));
+    CHECK(speed == 5 && dir == 2.5f && trim == -3);
+    CHECK(strcmp(label, "abc") == 0);
+
+    // Any invalid value discards the whole line
+    const char* const invalid[] = {
+        "speed abc dir 1.5",    // Not a number
+        "dir 1.5 speed 12x",    // Trailing characters
+        "dir 1.5 speed 70000",  // Out of range for uint16_t
+        "dir 1.5 speed -1",     // Negative for unsigned
+        "dir 1.5 trim 200",     // Out of range for int8_t
+        "dir nan speed 7",      // Not finite
+        "dir 1e39 speed 7",     // Out of range for float
+        "dir 1.5 label 0123456789abcdef", // Longer than CLI_VALUE_LEN - 1
+    };
+    for(const char* line : invalid){
+        CHECK(!apply(cli, stream, line));
+        CHECK(test::contains(stream.output, "Invalid value: "));
+    }
+    CHECK(speed == 5 && dir == 2.5f && trim == -3);
+    CHECK(strcmp(label, "abc") == 0);
+
+    // Longest string that fits
+    CHECK(apply(cli, stream, "label 0123456789abcde"));
+    CHECK(strcmp(label, "0123456789abcde") == 0);
+
+    // Table entries are staged the same way
+    CHECK(cli.add_arguments(table));
+    CHECK(!apply(cli, stream, "t-set 5 t-dir abc"));
+    CHECK(table_calls == 0 && dir == 2.5f);
+    CHECK(apply(cli, stream, "t-set -300 t-dir 0.5"));
+    CHECK(table_value == -300 && table_calls == 1 && dir == 0.5f);
+
+    // stop would act before the line is committed, so it is rejected
+    uint32_t before = spins;
+    CHECK(!apply(cli, stream, "speed 9 stop spin"));
+    CHECK(test::contains(stream.output, "Cannot be staged: stop"));
+    CHECK(speed == 5);
+    CHECK(spins > before); // Still running
+
+    // Lines staged by one thread and committed by another are applied whole
+    cli.add_argument("left", "Bound uint16_t.", &left);
+    cli.add_argument("right", "Bound uint16_t.", &right);
+    stream.capture = false;
+    const uint16_t n = 20000;
+    std::atomic<bool> done{false};
+    uint32_t commits = 0;
+    bool whole = true;
+    std::thread committer([&]{
+        while(!done){
+            if(cli.commit()){
+                commits++;
+                whole = whole && left == right;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if(cli.commit()){ commits++; }
+    });
+    char line[32];
+    for(uint16_t i = 1; i <= n; i++){
+        snprintf(line, sizeof(line), "left %u right %u\n", i, i);
+        for(const char* c = line; *c; c++){ cli.feed(*c); }
+    }
+    done = true;
+    committer.join();
+    CHECK(whole);
+    CHECK(commits > 0);
+
+    return TEST_RESULT();
+}
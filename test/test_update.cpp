@@ -0,0 +1,79 @@
+/*
+ * `update()` only consumes bytes that have arrived and parses a command once
+ * its newline is received. Lines longer than the buffer are discarded.
+ */
+
+#define CLI_HELP // Help text is stored straight after the name
+#include <Arduino.h>
+#include <arduino_clap.h>
+#include "test_util.h"
+
+namespace {
+    int speed = -1;
+    int calls = 0;
+    int longest_calls = 0;
+
+    void set_speed(int v){ speed = v; calls++; }
+    void longest(){ longest_calls++; }
+}
+
+int main(){
+    MockStream stream;
+    ArduinoCLI cli(stream);
+    cli.add_argument<int>("speed", "Set the speed.", set_speed);
+    cli.add_argument("abcdefghijklmno", "Longest name (15).", longest);
+
+    // Partial line: nothing is parsed and update() returns immediately
+    stream.push("spe");
+    uint32_t start = millis();
+    CHECK(!cli.update());
+    CHECK(millis() == start);
+    CHECK(calls == 0);
+
+    // Rest of the line arrives later
+    stream.schedule(millis() + 5, "ed 42\r\n");
+    for(int i = 0; i < 4; i++){
+        delay(1);
+        cli.update();
+    }
+    CHECK(calls == 0);
+    delay(1);
+    cli.update();
+    CHECK(calls == 1);
+    CHECK(speed == 42);
+    CHECK(test::contains(stream.output, "speed 42\r\n"));
+
+    // One command per call
+    stream.push("speed 1\nspeed 2\n");
+    cli.update();
+    CHECK(speed == 1);
+    cli.update();
+    CHECK(speed == 2);
+
+    // feed() shares the line buffer logic
+    for(const char* c = "speed 7\n"; *c; c++){ cli.feed(*c); }
+    CHECK(speed == 7);
+
+    // A line longer than the buffer is discarded, not parsed truncated
+    int before = calls;
+    stream.push("speed " + std::string(96, '1') + "\n");
+    cli.update();
+    CHECK(calls == before);
+    CHECK(test::contains(stream.output, "Line too long, nothing applied."));
+    stream.push("speed 8 " + std::string(90, ' ') + "speed 12345\n");
+    cli.update();
+    CHECK(calls == before);
+    stream.push("speed 9\n"); // The next line is parsed as normal
+    cli.update();
+    CHECK(speed == 9);
+
+    // The longest allowed name is stored with its terminator
+    stream.push("abcdefghijklmno\n");
+    cli.update();
+    CHECK(longest_calls == 1);
+
+    stream.push("exit\n");
+    CHECK(cli.update());
+
+    return TEST_RESULT();
+}
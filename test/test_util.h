@@ -0,0 +1,29 @@
+/*
+ * Minimal assertions for the host tests. A failed check prints its location
+ * and makes the test exit with a non-zero status.
+ */
+
+#ifndef CLAP_TEST_UTIL_H
+#define CLAP_TEST_UTIL_H
+
+#include <cstdio>
+#include <string>
+
+namespace test {
+    int failures = 0;
+
+    inline bool contains(const std::string& haystack, const char* needle){
+        return haystack.find(needle) != std::string::npos;
+    }
+}
+
+#define CHECK(cond) do { \
+    if(!(cond)){ \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        test::failures++; \
+    } \
+} while(0)
+
+#define TEST_RESULT() (test::failures ? 1 : 0)
+
+#endif // CLAP_TEST_UTIL_H
@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+#
+# Report the code size of each example with each optional module enabled.
+#
+# Host: every example is compiled with the host compiler against the Arduino
+# shim (test/shim) at -Os with unused sections removed, and the .text, .data
+# and .bss sizes are printed along with the change from the example as
+# written. Absolute host numbers include the shim and C++ runtime, the deltas
+# are what each module costs.
+#
+# Target: if arduino-cli is installed, each example is also compiled for the
+# boards in FOOTPRINT_FQBNS (default "arduino:avr:uno") and the flash and RAM
+# use reported by the Arduino toolchain (avr-gcc, arm-none-eabi-gcc etc.) is
+# printed.
+#
+#     tools/footprint.sh [example ...]
+
+set -u
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+cxx="${CXX:-c++}"
+size_tool="${SIZE:-size}"
+fqbns="${FOOTPRINT_FQBNS:-arduino:avr:uno}"
+features="CLI_HELP CLI_RANGE_LOOP CLI_QUOTED_STRINGS CLI_FLOAT CLI_SNAPSHOT
+          CLI_ASYNC CLI_HASH_INDEX CLI_TRANSACTIONS CLI_QUEUE CLI_FULL"
+
+if [ "$#" -gt 0 ]; then
+    examples="$*"
+else
+    examples="$(cd "$root/examples" && ls *.cpp | sed 's/\.cpp$//')"
+fi
+
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+cflags="-std=c++11 -Os -w -ffunction-sections -fdata-sections
+        -I$root/src -I$root/test/shim"
+
+"$cxx" $cflags -c "$root/test/shim/Arduino.cpp" -o "$work/Arduino.o" &&
+"$cxx" $cflags -c "$root/test/shim/example_main.cpp" -o "$work/main.o" ||
+    exit 1
+
+# Print "text data bss" for an example built with the given define
+host_size(){
+    local example="$1" define="$2" flags=""
+    [ -n "$define" ] && flags="-D$define"
+    "$cxx" $cflags $flags "$root/examples/$example.cpp" "$work/Arduino.o" \
+        "$work/main.o" -Wl,--gc-sections -o "$work/$example" 2>/dev/null &&
+        "$size_tool" "$work/$example" | awk 'NR == 2 { print $1, $2, $3 }'
+}
+
+printf "%-8s %-16s %-20s %8s %8s %8s %8s\n" \
+    target example features text data bss "text+/-"
+for example in $examples; do
+    read -r text data bss <<< "$(host_size "$example" "")"
+    if [ -z "${text:-}" ]; then
+        printf "%-8s %-16s %-20s %s\n" host "$example" "(example)" "build failed"
+        continue
+    fi
+    printf "%-8s %-16s %-20s %8s %8s %8s\n" \
+        host "$example" "(example)" "$text" "$data" "$bss"
+    for feature in $features; do
+        read -r f_text f_data f_bss <<< "$(host_size "$example" "$feature")"
+        if [ -z "${f_text:-}" ]; then
+            printf "%-8s %-16s %-20s %s\n" host "$example" "+$feature" \
+                "build failed"
+            continue
+        fi
+        printf "%-8s %-16s %-20s %8s %8s %8s %+8d\n" host "$example" \
+            "+$feature" "$f_text" "$f_data" "$f_bss" $((f_text - text))
+    done
+done
+
+if ! command -v arduino-cli > /dev/null; then
+    echo "arduino-cli not found, skipping target builds"
+    exit 0
+fi
+
+echo
+printf "%-20s %-16s %-20s %8s %8s\n" board example features flash ram
+for fqbn in $fqbns; do
+    for example in $examples; do
+        # arduino-cli builds sketches: <name>/<name>.ino
+        sketch="$work/sketch/$example"
+        mkdir -p "$sketch"
+        cp "$root/examples/$example.cpp" "$sketch/$example.ino"
+        for feature in "" $features; do
+            props=()
+            [ -n "$feature" ] && props=(--build-property
+                "compiler.cpp.extra_flags=-D$feature")
+            log="$(arduino-cli compile --fqbn "$fqbn" --library "$root" \
+                   "${props[@]}" "$sketch" 2>&1)"
+            flash="$(sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p' <<< "$log")"
+            ram="$(sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p' \
+                   <<< "$log")"
+            printf "%-20s %-16s %-20s %8s %8s\n" "$fqbn" "$example" \
+                "${feature:+"+$feature"}${feature:-"(example)"}" \
+                "${flash:-failed}" "${ram:-}"
+        done
+    done
+done